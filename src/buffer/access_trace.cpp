@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_trace.cpp
+//
+// Identification: src/buffer/access_trace.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/access_trace.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+AccessTrace::AccessTrace(size_t capacity) : slots_(capacity) {
+  BUSTUB_ASSERT(capacity > 0, "An access trace needs room for at least one access");
+}
+
+auto AccessTrace::Snapshot() const -> std::vector<AccessRecord> {
+  const uint64_t end = next_.load(std::memory_order_relaxed);
+  const uint64_t begin = std::max(start_.load(std::memory_order_relaxed), end - std::min<uint64_t>(end, slots_.size()));
+
+  std::vector<AccessRecord> records;
+  records.reserve(end - begin);
+  for (uint64_t seq = begin; seq < end; seq++) {
+    const uint64_t slot = slots_[seq % slots_.size()].load(std::memory_order_relaxed);
+    if ((slot >> (64 - SEQ_BITS)) != ((seq + 1) & ((uint64_t{1} << SEQ_BITS) - 1))) {
+      continue;
+    }
+    records.push_back({static_cast<AccessType>((slot >> 32) & 0x3), static_cast<page_id_t>(slot & 0xFFFFFFFF)});
+  }
+  return records;
+}
+
+auto AccessTrace::WriteTo(std::ostream &os) const -> size_t {
+  static constexpr char TYPE_CHARS[] = {'F', 'N', 'D'};
+  const auto records = Snapshot();
+  for (const auto &record : records) {
+    os << TYPE_CHARS[static_cast<size_t>(record.type_)] << ' ' << record.page_id_ << '\n';
+  }
+  return records.size();
+}
+
+auto AccessTrace::ReadFrom(std::istream &is) -> std::vector<AccessRecord> {
+  std::vector<AccessRecord> records;
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    char type;
+    page_id_t page_id;
+    if (!(fields >> type >> page_id)) {
+      throw Exception("malformed access trace line: " + line);
+    }
+    switch (type) {
+      case 'F':
+        records.push_back({AccessType::FETCH, page_id});
+        break;
+      case 'N':
+        records.push_back({AccessType::NEW, page_id});
+        break;
+      case 'D':
+        records.push_back({AccessType::DELETE, page_id});
+        break;
+      default:
+        throw Exception("unknown access type in access trace line: " + line);
+    }
+  }
+  return records;
+}
+
+}  // namespace bustub
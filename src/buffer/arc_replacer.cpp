@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ArcReplacer::ArcReplacer(size_t num_frames) : num_frames_(num_frames), frames_(num_frames) {}
+
+auto ArcReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  if (t1_evictable_ + t2_evictable_ == 0) {
+    return false;
+  }
+  const bool from_t1 = EvictFromT1(t1_.size(), t1_evictable_, t2_evictable_);
+  auto &list = from_t1 ? t1_ : t2_;
+  auto victim = std::find_if(list.rbegin(), list.rend(), [&](frame_id_t id) { return frames_[id].evictable_; });
+  BUSTUB_ASSERT(victim != list.rend(), "an evictable frame is always in its list");
+
+  *frame_id = *victim;
+  const page_id_t page_id = frames_[*frame_id].page_id_;
+  Forget(*frame_id);
+  if (page_id != INVALID_PAGE_ID) {
+    AddGhost(page_id, from_t1 ? ArcList::B1 : ArcList::B2);
+  }
+  return true;
+}
+
+void ArcReplacer::RecordAccess(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.list_ == ArcList::T1) {
+    // The second access promotes the frame to T2.
+    t2_.splice(t2_.begin(), t1_, frame.pos_);
+    frame.list_ = ArcList::T2;
+    if (frame.evictable_) {
+      t1_evictable_--;
+      t2_evictable_++;
+    }
+    return;
+  }
+  if (frame.list_ == ArcList::T2) {
+    t2_.splice(t2_.begin(), t2_, frame.pos_);
+    return;
+  }
+
+  // A new page. If it was evicted recently, the list it was evicted from should have been larger.
+  ArcList list = ArcList::T1;
+  auto ghost = ghosts_.find(frame.page_id_);
+  if (ghost != ghosts_.end()) {
+    if (ghost->second.list_ == ArcList::B1) {
+      const size_t delta = std::max<size_t>(1, b2_.size() / b1_.size());
+      target_t1_size_ = std::min(capacity_, target_t1_size_ + delta);
+    } else {
+      const size_t delta = std::max<size_t>(1, b1_.size() / b2_.size());
+      target_t1_size_ -= std::min(target_t1_size_, delta);
+    }
+    EraseGhost(frame.page_id_);
+    list = ArcList::T2;
+  }
+  auto &resident = ResidentList(list);
+  resident.push_front(frame_id);
+  frame.pos_ = resident.begin();
+  frame.list_ = list;
+  capacity_ = std::max(capacity_, t1_.size() + t2_.size());
+}
+
+void ArcReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  frames_[frame_id].page_id_ = page_id;
+}
+
+void ArcReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.list_ == ArcList::NONE || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  size_t &evictable = frame.list_ == ArcList::T1 ? t1_evictable_ : t2_evictable_;
+  if (set_evictable) {
+    evictable++;
+  } else {
+    evictable--;
+  }
+}
+
+void ArcReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  // The page is gone rather than evicted, so it does not become a ghost.
+  if (frames_[frame_id].evictable_) {
+    Forget(frame_id);
+  }
+}
+
+auto ArcReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  // Replay Evict() on copies of the list sizes, walking both lists from their LRU end.
+  std::vector<frame_id_t> candidates;
+  size_t t1_size = t1_.size();
+  size_t t1_evictable = t1_evictable_;
+  size_t t2_evictable = t2_evictable_;
+  auto t1_it = t1_.rbegin();
+  auto t2_it = t2_.rbegin();
+  while (candidates.size() < max_count && t1_evictable + t2_evictable > 0) {
+    const bool from_t1 = EvictFromT1(t1_size, t1_evictable, t2_evictable);
+    auto &it = from_t1 ? t1_it : t2_it;
+    while (!frames_[*it].evictable_) {
+      ++it;
+    }
+    candidates.push_back(*it++);
+    if (from_t1) {
+      t1_size--;
+      t1_evictable--;
+    } else {
+      t2_evictable--;
+    }
+  }
+  return candidates;
+}
+
+auto ArcReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return t1_evictable_ + t2_evictable_;
+}
+
+auto ArcReplacer::GetTargetT1Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return target_t1_size_;
+}
+
+void ArcReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range of the ARC replacer");
+  }
+}
+
+auto ArcReplacer::EvictFromT1(size_t t1_size, size_t t1_evictable, size_t t2_evictable) const -> bool {
+  return t1_evictable > 0 && (t1_size > target_t1_size_ || t2_evictable == 0);
+}
+
+void ArcReplacer::Forget(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  ResidentList(frame.list_).erase(frame.pos_);
+  if (frame.evictable_) {
+    (frame.list_ == ArcList::T1 ? t1_evictable_ : t2_evictable_)--;
+  }
+  frame = FrameInfo{};
+}
+
+void ArcReplacer::AddGhost(page_id_t page_id, ArcList list) {
+  auto &ghost_list = list == ArcList::B1 ? b1_ : b2_;
+  ghost_list.push_front(page_id);
+  ghosts_[page_id] = GhostInfo{list, ghost_list.begin()};
+
+  // |T1| + |B1| <= c, and all four lists together hold at most 2c pages.
+  while (!b1_.empty() && t1_.size() + b1_.size() > capacity_) {
+    EraseGhost(b1_.back());
+  }
+  while (!ghosts_.empty() && t1_.size() + t2_.size() + ghosts_.size() > 2 * capacity_) {
+    EraseGhost(b2_.empty() ? b1_.back() : b2_.back());
+  }
+}
+
+void ArcReplacer::EraseGhost(page_id_t page_id) {
+  auto ghost = ghosts_.find(page_id);
+  (ghost->second.list_ == ArcList::B1 ? b1_ : b2_).erase(ghost->second.pos_);
+  ghosts_.erase(ghost);
+}
+
+}  // namespace bustub
@@ -12,18 +12,50 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <cstring>
+#include <future>  // NOLINT
+#include <new>
+#include <utility>
+
 #include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+                                                     LogManager *log_manager, size_t max_pool_size,
+                                                     ReplacerPolicy replacer_policy)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, max_pool_size,
+                                replacer_policy) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, size_t max_pool_size,
+                                                     ReplacerPolicy replacer_policy)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      replacer_policy_(replacer_policy),
+      replacer_k_(replacer_k) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // we allocate a consecutive memory space for the buffer pool, and a dense array with the metadata of each frame
+  // All of it is sized for max_pool_size_ frames, so that Resize() never has to move a frame.
+  frame_arena_ = new FrameArena(max_pool_size_);
+  pages_ = static_cast<Page *>(::operator new(max_pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    new (&pages_[i]) Page(frame_arena_->GetFrameData(static_cast<frame_id_t>(i)));
+  }
+  io_in_progress_.resize(max_pool_size_, false);
+  io_cv_ = std::vector<std::condition_variable_any>(max_pool_size_);
+  page_table_ = new PageTable(max_pool_size_);
+  replacer_ = CreateReplacer(replacer_policy_, max_pool_size_, replacer_k_);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -32,7 +64,27 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManag
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  if (flush_thread_.joinable()) {
+    {
+      std::lock_guard<TimedMutex> lock(latch_);
+      flush_stop_ = true;
+    }
+    flush_cv_.notify_one();
+    flush_thread_.join();
+  }
+  if (prefetch_thread_.joinable()) {
+    {
+      std::lock_guard<TimedMutex> lock(latch_);
+      prefetch_stop_ = true;
+    }
+    prefetch_cv_.notify_one();
+    prefetch_thread_.join();
+  }
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete(pages_);
+  delete frame_arena_;
   delete page_table_;
   delete replacer_;
 }
@@ -41,110 +93,350 @@ BufferPoolManagerInstance::~BufferPoolManagerInstance() {
 // [2] No free frames. Evict a frame with the replacement policy.
 // [3] No free frames, and no evictable frames.
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
+  std::unique_lock<TimedMutex> lock(latch_);
 
   // If every page has a pin count > 0, there are no free frames and no evictable frames.
-  bool has_avail_frame = false;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].GetPinCount() == 0) {
-      has_avail_frame = true;
-      break;
-    }
-  }
-
-  if (!has_avail_frame) {
+  if (!HasAvailableFrame()) {
+    metrics_.RecordFailedFetch();
     return nullptr;
   }
 
   *page_id = AllocatePage();
+  TraceAccess(AccessType::NEW, *page_id);
+  Page *page = LoadPage(*page_id, false, nullptr, &lock);
+  if (page == nullptr) {
+    // The victim could not be written back, so the new page id goes unused.
+    lock.unlock();
+    DeallocatePage(*page_id);
+  }
+  return page;
+}
 
-  frame_id_t frame_id;
+auto BufferPoolManagerInstance::AllocateExtentImp(size_t num_pages) -> page_id_t {
+  return disk_manager_->AllocateExtent(num_pages);
+}
 
-  // Make room for the new page.
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    replacer_->Evict(&frame_id);
-    // Is it a dirty page?
-    page_id_t evicted_page_id = pages_[frame_id].GetPageId();
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(evicted_page_id, pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
-    }
+auto BufferPoolManagerInstance::NewPgInExtentImp(page_id_t page_id) -> Page * {
+  ValidatePageId(page_id);
+  BUSTUB_ASSERT(disk_manager_->IsPageAllocated(page_id), "The page must be reserved by AllocateExtent()");
+  std::unique_lock<TimedMutex> lock(latch_);
 
-    pages_[frame_id].ResetMemory();
-    page_table_->Remove(evicted_page_id);
+  // A page that is resident, or still being written back, was created before.
+  frame_id_t frame_id;
+  if (page_table_->Find(page_id, frame_id) || write_back_pages_.count(page_id) > 0) {
+    return nullptr;
   }
 
-  page_table_->Insert(*page_id, frame_id);
-  pages_[frame_id].page_id_ = *page_id;
-  pages_[frame_id].pin_count_ = 1;
-
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
+  if (!HasAvailableFrame()) {
+    metrics_.RecordFailedFetch();
+    return nullptr;
+  }
 
-  return &pages_[frame_id];
+  TraceAccess(AccessType::NEW, page_id);
+  return LoadPage(page_id, false, nullptr, &lock);
 }
 
 // [1] Page is in the buffer pool.
 // [2] Page is not in the buffer pool.
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::lock_guard<std::mutex> lock(latch_);
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return FetchPgBulkImp(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::FetchPgBulkImp(page_id_t page_id, BufferRing *ring) -> Page * {
+  TraceAccess(AccessType::FETCH, page_id);
+  std::unique_lock<TimedMutex> lock(latch_);
 
   frame_id_t frame_id;
-  if (page_table_->Find(page_id, frame_id)) {
-    pages_[frame_id].pin_count_++;
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    return &pages_[frame_id];
+  while (true) {
+    if (page_table_->Find(page_id, frame_id)) {
+      metrics_.RecordHit();
+      pages_[frame_id].pin_count_++;
+      replacer_->RecordAccess(frame_id);
+      replacer_->SetEvictable(frame_id, false);
+      // Another thread may still be reading the page in. Our pin keeps the frame from being reused meanwhile.
+      if (io_in_progress_[frame_id]) {
+        metrics_.RecordPinWait();
+        io_cv_[frame_id].wait(lock, [&] { return !io_in_progress_[frame_id]; });
+        if (pages_[frame_id].GetPageId() != page_id) {
+          // The read failed.
+          UnpinFailedFrame(frame_id);
+          return nullptr;
+        }
+      }
+      return &pages_[frame_id];
+    }
+    if (write_back_pages_.count(page_id) == 0) {
+      break;
+    }
+    // The page was just evicted and is still being written back, so the copy on disk is stale.
+    metrics_.RecordPinWait();
+    write_back_cv_.wait(lock);
   }
 
-  bool has_avail_frame = false;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].GetPinCount() == 0) {
-      has_avail_frame = true;
-      break;
+  if (!HasAvailableFrame()) {
+    metrics_.RecordFailedFetch();
+    return nullptr;
+  }
+
+  metrics_.RecordMiss();
+  return LoadPage(page_id, true, ring, &lock);
+}
+
+auto BufferPoolManagerInstance::FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  std::vector<frame_id_t> hit_frames;
+  std::vector<FrameIO> misses;
+  std::vector<size_t> deferred;
+
+  std::unique_lock<TimedMutex> lock(latch_);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    const page_id_t page_id = page_ids[i];
+    frame_id_t frame_id;
+    if (page_table_->Find(page_id, frame_id)) {
+      // This includes pages that appeared earlier in page_ids, whose I/O is ours to do. Waiting comes last.
+      TraceAccess(AccessType::FETCH, page_id);
+      metrics_.RecordHit();
+      pages_[frame_id].pin_count_++;
+      replacer_->RecordAccess(frame_id);
+      replacer_->SetEvictable(frame_id, false);
+      hit_frames.push_back(frame_id);
+    } else if (write_back_pages_.count(page_id) > 0) {
+      // Fetched (and traced) by FetchPgBulkImp(), which waits for the write back without holding our other pages.
+      deferred.push_back(i);
+      continue;
+    } else if (HasAvailableFrame()) {
+      TraceAccess(AccessType::FETCH, page_id);
+      metrics_.RecordMiss();
+      misses.push_back(AdmitPage(page_id, true, nullptr));
+      frame_id = misses.back().frame_id_;
+    } else {
+      TraceAccess(AccessType::FETCH, page_id);
+      metrics_.RecordFailedFetch();
+      continue;
+    }
+    pages[i] = &pages_[frame_id];
+  }
+
+  if (!misses.empty()) {
+    // Read in file order, so that neighboring pages are read back to back.
+    std::sort(misses.begin(), misses.end(), [](const FrameIO &a, const FrameIO &b) { return a.page_id_ < b.page_id_; });
+    lock.unlock();
+    DoFrameIOs(&misses);
+    lock.lock();
+    for (const auto &io : misses) {
+      FinishFrameIO(io);
+    }
+  }
+
+  // Only other threads' I/O is left to wait for.
+  for (auto frame_id : hit_frames) {
+    if (io_in_progress_[frame_id]) {
+      metrics_.RecordPinWait();
+      io_cv_[frame_id].wait(lock, [&] { return !io_in_progress_[frame_id]; });
+    }
+  }
+  // Give up the pages whose read failed, ours or another thread's. Every position holds a pin of its own.
+  for (size_t i = 0; i < pages.size(); i++) {
+    if (pages[i] != nullptr && pages[i]->GetPageId() != page_ids[i]) {
+      UnpinFailedFrame(static_cast<frame_id_t>(pages[i] - pages_));
+      pages[i] = nullptr;
     }
   }
+  lock.unlock();
 
-  if (!has_avail_frame) {
+  for (auto i : deferred) {
+    pages[i] = FetchPgBulkImp(page_ids[i], nullptr);
+  }
+  return pages;
+}
+
+auto BufferPoolManagerInstance::LoadPage(page_id_t page_id, bool read_page, BufferRing *ring,
+                                         std::unique_lock<TimedMutex> *lock) -> Page * {
+  FrameIO io = AdmitPage(page_id, read_page, ring);
+  Page *page = &pages_[io.frame_id_];
+  if (!io.write_back_ && !io.read_page_) {
+    page->ResetMemory();
+    return page;
+  }
+
+  // Do the I/O without the latch. Fetchers of page_id find the frame in the page table and wait for it, fetchers of
+  // the evicted page wait for the write back, and everybody else goes ahead.
+  lock->unlock();
+  DoFrameIO(&io);
+  lock->lock();
+  FinishFrameIO(io);
+  if (io.Failed()) {
+    UnpinFailedFrame(io.frame_id_);
     return nullptr;
   }
+  return page;
+}
+
+auto BufferPoolManagerInstance::AdmitPage(page_id_t page_id, bool read_page, BufferRing *ring) -> FrameIO {
+  // Make room for the page.
+  const frame_id_t frame_id = TakeFrame(page_id, ring);
+  Page *page = &pages_[frame_id];
+  const FrameIO io{frame_id, page_id, page->GetPageId(), page->IsDirty(), read_page};
+  if (io.evicted_page_id_ != INVALID_PAGE_ID) {
+    metrics_.RecordEviction();
+    page_table_->Remove(io.evicted_page_id_);
+  }
+  if (io.write_back_) {
+    metrics_.RecordWriteBacks(1);
+    write_back_pages_.insert(io.evicted_page_id_);
+    // The flusher fell behind, let it catch up on the next victims.
+    flush_cv_.notify_one();
+  }
+
+  page_table_->Insert(page_id, frame_id);
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+
+  replacer_->SetPageId(frame_id, page_id);
+  replacer_->RecordAccess(frame_id);
+  replacer_->SetEvictable(frame_id, false);
+
+  if (io.write_back_ || io.read_page_) {
+    io_in_progress_[frame_id] = true;
+  }
+  return io;
+}
+
+auto BufferPoolManagerInstance::TakeFrame(page_id_t page_id, BufferRing *ring) -> frame_id_t {
+  BufferRing::Slots *slots = nullptr;
+  std::pair<frame_id_t, page_id_t> *slot = nullptr;
+  if (ring != nullptr) {
+    if (ring->slots_.size() < num_instances_) {
+      ring->slots_.resize(num_instances_);
+    }
+    slots = &ring->slots_[instance_index_];
+    const size_t ring_size = std::max<size_t>(2, std::min(ring->GetRingSize(), pool_size_ / 8));
+    if (slots->frames_.size() >= ring_size) {
+      slot = &slots->frames_[slots->next_];
+      slots->next_ = (slots->next_ + 1) % slots->frames_.size();
+      Page &page = pages_[slot->first];
+      // Reuse the frame only if it still holds our page and nobody else is using it.
+      if (page.GetPageId() == slot->second && page.GetPinCount() == 0) {
+        replacer_->Remove(slot->first);
+        slot->second = page_id;
+        return slot->first;
+      }
+    }
+  }
 
-  // Make room for the page to be loaded from disk.
+  frame_id_t frame_id;
   if (!free_list_.empty()) {
     // A free frame is not dirty.
     frame_id = free_list_.front();
     free_list_.pop_front();
   } else {
     replacer_->Evict(&frame_id);
-    page_id_t evicted_page_id = pages_[frame_id].GetPageId();
+  }
 
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(evicted_page_id, pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
-    }
+  // Give the frame to the ring, replacing the frame that could not be reused.
+  if (slot != nullptr) {
+    *slot = {frame_id, page_id};
+  } else if (slots != nullptr) {
+    slots->frames_.emplace_back(frame_id, page_id);
+  }
+  return frame_id;
+}
 
-    page_table_->Remove(evicted_page_id);
-    pages_[frame_id].ResetMemory();
+void BufferPoolManagerInstance::DoFrameIO(FrameIO *io) {
+  Page *page = &pages_[io->frame_id_];
+  if (io->write_back_) {
+    try {
+      disk_manager_->WritePage(io->evicted_page_id_, page->GetData());
+    } catch (const Exception &e) {
+      io->write_failed_ = true;
+      return;
+    }
   }
+  page->ResetMemory();
+  if (io->read_page_) {
+    try {
+      disk_manager_->ReadPage(io->page_id_, page->GetData());
+    } catch (const Exception &e) {
+      io->read_failed_ = true;
+    }
+  }
+}
 
-  page_table_->Insert(page_id, frame_id);
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].pin_count_ = 1;
+void BufferPoolManagerInstance::DoFrameIOs(std::vector<FrameIO> *ios) {
+  std::vector<std::pair<FrameIO *, std::future<void>>> writes;
+  for (auto &io : *ios) {
+    if (io.write_back_) {
+      writes.emplace_back(&io, disk_manager_->WritePageAsync(io.evicted_page_id_, pages_[io.frame_id_].GetData()));
+    }
+  }
+  for (auto &[io, write] : writes) {
+    try {
+      write.get();
+    } catch (const Exception &e) {
+      io->write_failed_ = true;
+    }
+  }
 
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
+  std::vector<std::pair<FrameIO *, std::future<void>>> reads;
+  for (auto &io : *ios) {
+    if (io.write_failed_) {
+      continue;
+    }
+    Page *page = &pages_[io.frame_id_];
+    page->ResetMemory();
+    if (io.read_page_) {
+      reads.emplace_back(&io, disk_manager_->ReadPageAsync(io.page_id_, page->GetData()));
+    }
+  }
+  for (auto &[io, read] : reads) {
+    try {
+      read.get();
+    } catch (const Exception &e) {
+      io->read_failed_ = true;
+    }
+  }
+}
 
-  disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+void BufferPoolManagerInstance::FinishFrameIO(const FrameIO &io) {
+  if (io.write_back_) {
+    write_back_pages_.erase(io.evicted_page_id_);
+    write_back_cv_.notify_all();
+  }
+  if (io.read_failed_) {
+    // The frame's memory is zeroed, and its pins hold it until every fetcher has given up.
+    page_table_->Remove(io.page_id_);
+    pages_[io.frame_id_].ResetMemory();
+    pages_[io.frame_id_].page_id_ = INVALID_PAGE_ID;
+  }
+  if (io.write_failed_) {
+    // The victim is still in the frame. Map it back, still dirty, so that it is neither lost nor read back stale.
+    page_table_->Remove(io.page_id_);
+    page_table_->Insert(io.evicted_page_id_, io.frame_id_);
+    pages_[io.frame_id_].page_id_ = io.evicted_page_id_;
+    pages_[io.frame_id_].is_dirty_ = true;
+    replacer_->SetPageId(io.frame_id_, io.evicted_page_id_);
+  }
+  io_in_progress_[io.frame_id_] = false;
+  io_cv_[io.frame_id_].notify_all();
+}
 
-  return &pages_[frame_id];
+void BufferPoolManagerInstance::UnpinFailedFrame(frame_id_t frame_id) {
+  if (--pages_[frame_id].pin_count_ > 0) {
+    return;
+  }
+  if (pages_[frame_id].GetPageId() != INVALID_PAGE_ID) {
+    // The frame went back to the victim of a failed write back, which stays resident.
+    replacer_->SetEvictable(frame_id, true);
+    return;
+  }
+  // Untrack the frame, which the replacer only lets go of once it is evictable.
+  replacer_->SetEvictable(frame_id, true);
+  replacer_->Remove(frame_id);
+  free_list_.push_back(frame_id);
 }
 
 // We got a Page* from FetchPgImp or NewPgImp earlier, and now we are done with it.
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
+  std::lock_guard<TimedMutex> lock(latch_);
 
   frame_id_t frame_id;
   if (!page_table_->Find(page_id, frame_id)) {
@@ -171,48 +463,74 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
+  std::unique_lock<TimedMutex> lock(latch_);
 
   frame_id_t frame_id;
 
-  if (!page_table_->Find(page_id, frame_id)) {
-    return false;
+  // Wait until the page is fully read in, it may be gone by then.
+  while (true) {
+    if (!page_table_->Find(page_id, frame_id)) {
+      return false;
+    }
+    if (!io_in_progress_[frame_id]) {
+      break;
+    }
+    io_cv_[frame_id].wait(lock);
   }
 
-  disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+  try {
+    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+  } catch (const Exception &e) {
+    // The page stays dirty, the disk does not have it.
+    return false;
+  }
   pages_[frame_id].is_dirty_ = false;
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::lock_guard<std::mutex> lock(latch_);
+  std::lock_guard<TimedMutex> lock(latch_);
   for (size_t i = 0; i < pool_size_; i++) {
-
-    // not a free frame
-    if (pages_[i].GetPageId() != INVALID_PAGE_ID) {
-      FlushPgImp(pages_[i].GetPageId());
+    // not a free frame, and not being loaded. Write it directly, since FlushPgImp() would re-acquire latch_.
+    if (pages_[i].GetPageId() != INVALID_PAGE_ID && !io_in_progress_[i]) {
+      try {
+        disk_manager_->WritePage(pages_[i].GetPageId(), pages_[i].GetData());
+        pages_[i].is_dirty_ = false;
+      } catch (const Exception &e) {
+        // The page stays dirty, the disk does not have it.
+      }
     }
   }
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::lock_guard<std::mutex> lock(latch_);
+  TraceAccess(AccessType::DELETE, page_id);
+  std::unique_lock<TimedMutex> lock(latch_);
 
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id)) {
-    // Page not in the buffer pool.
-    return true;
+  // A write back or read of the page that is still in flight would land after the deallocation.
+  while (true) {
+    if (page_table_->Find(page_id, frame_id)) {
+      if (!io_in_progress_[frame_id]) {
+        break;
+      }
+      io_cv_[frame_id].wait(lock);
+    } else if (write_back_pages_.count(page_id) > 0) {
+      write_back_cv_.wait(lock);
+    } else {
+      // Page not in the buffer pool.
+      lock.unlock();
+      DeallocatePage(page_id);
+      return true;
+    }
   }
 
   if (pages_[frame_id].GetPinCount() > 0) {
     return false;
   }
 
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
-  }
-
+  // The page is gone, so its changes need not be written back.
+  pages_[frame_id].is_dirty_ = false;
   pages_[frame_id].page_id_ = INVALID_PAGE_ID;
   pages_[frame_id].pin_count_ = 0;
   pages_[frame_id].ResetMemory();
@@ -223,10 +541,250 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
 
   replacer_->Remove(frame_id);
 
+  lock.unlock();
+  DeallocatePage(page_id);
+  return true;
+}
+
+auto BufferPoolManagerInstance::Resize(size_t pool_size) -> bool {
+  std::lock_guard<TimedMutex> lock(latch_);
+
+  const size_t old_pool_size = pool_size_;
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  if (pool_size >= old_pool_size) {
+    // The new frames are still empty and zeroed, so they can go on the free list as they are.
+    for (size_t i = old_pool_size; i < pool_size; ++i) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = pool_size;
+    return true;
+  }
+
+  // A pinned frame cannot go away. Frames with I/O in progress are always pinned.
+  for (size_t i = pool_size; i < old_pool_size; ++i) {
+    if (pages_[i].GetPinCount() > 0) {
+      return false;
+    }
+  }
+
+  // The pages beyond the free frames that stay are evicted. Write back the dirty ones first, so that a write that fails
+  // leaves everything as it was.
+  size_t num_free_frames = std::count_if(free_list_.begin(), free_list_.end(),
+                                         [&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) < pool_size; });
+  for (size_t i = pool_size; i < old_pool_size; ++i) {
+    Page &page = pages_[i];
+    if (page.GetPageId() == INVALID_PAGE_ID) {
+      continue;
+    }
+    if (num_free_frames > 0) {
+      num_free_frames--;
+    } else if (page.IsDirty()) {
+      try {
+        disk_manager_->WritePage(page.GetPageId(), page.GetData());
+      } catch (const Exception &e) {
+        return false;
+      }
+      metrics_.RecordWriteBacks(1);
+      page.is_dirty_ = false;
+    }
+  }
+
+  free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  for (size_t i = pool_size; i < old_pool_size; ++i) {
+    Page &page = pages_[i];
+    if (page.GetPageId() == INVALID_PAGE_ID) {
+      continue;
+    }
+    replacer_->Remove(static_cast<frame_id_t>(i));
+    page_table_->Remove(page.GetPageId());
+
+    if (!free_list_.empty()) {
+      // Keep the page in the buffer pool, in a free frame that stays. It starts over with a single access.
+      const frame_id_t frame_id = free_list_.front();
+      free_list_.pop_front();
+      Page &new_page = pages_[frame_id];
+      memcpy(new_page.GetData(), page.GetData(), BUSTUB_PAGE_SIZE);
+      new_page.page_id_ = page.GetPageId();
+      new_page.is_dirty_ = page.IsDirty();
+      new_page.pin_count_ = 0;
+      page_table_->Insert(new_page.GetPageId(), frame_id);
+      replacer_->SetPageId(frame_id, new_page.GetPageId());
+      replacer_->RecordAccess(frame_id);
+      replacer_->SetEvictable(frame_id, true);
+    } else {
+      // Written back above.
+      metrics_.RecordEviction();
+    }
+    page.page_id_ = INVALID_PAGE_ID;
+    page.is_dirty_ = false;
+  }
+
+  pool_size_ = pool_size;
+  frame_arena_->ReleaseFrames(static_cast<frame_id_t>(pool_size), static_cast<frame_id_t>(old_pool_size));
+  return true;
+}
+
+auto BufferPoolManagerInstance::SetReplacerPolicy(ReplacerPolicy policy) -> bool {
+  std::lock_guard<TimedMutex> lock(latch_);
+
+  Replacer *replacer = CreateReplacer(policy, max_pool_size_, replacer_k_);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    // Frames with a pin count of 0 are exactly the evictable ones, including the frames of rings.
+    const auto frame_id = static_cast<frame_id_t>(i);
+    if (pages_[i].GetPageId() != INVALID_PAGE_ID) {
+      replacer->SetPageId(frame_id, pages_[i].GetPageId());
+      replacer->RecordAccess(frame_id);
+      replacer->SetEvictable(frame_id, pages_[i].GetPinCount() == 0);
+    }
+  }
+  delete replacer_;
+  replacer_ = replacer;
+  replacer_policy_ = policy;
   return true;
+}
+
+auto BufferPoolManagerInstance::GetReplacerPolicy() -> ReplacerPolicy {
+  std::lock_guard<TimedMutex> lock(latch_);
+  return replacer_policy_;
+}
+
+void BufferPoolManagerInstance::StartBackgroundFlusher(size_t clean_frames) {
+  std::lock_guard<TimedMutex> lock(latch_);
+  BUSTUB_ASSERT(!flush_thread_.joinable(), "The background flusher is already running");
+  flush_clean_frames_ = clean_frames;
+  flush_thread_ = std::thread(&BufferPoolManagerInstance::BackgroundFlush, this);
+}
+
+void BufferPoolManagerInstance::BackgroundFlush() {
+  std::unique_lock<TimedMutex> lock(latch_);
+  while (!flush_stop_) {
+    flush_cv_.wait_for(lock, background_flush_interval);
+    if (!flush_stop_) {
+      FlushVictims(&lock);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::FlushVictims(std::unique_lock<TimedMutex> *lock) {
+  // Nobody else holds a pin on an evictable frame, so clearing the dirty flag here is safe: anyone who modifies the
+  // page from now on has to fetch it and unpin it as dirty again.
+  std::vector<frame_id_t> frames;
+  for (auto frame_id : replacer_->EvictionCandidates(flush_clean_frames_)) {
+    Page *page = &pages_[frame_id];
+    if (page->IsDirty()) {
+      page->pin_count_++;
+      page->is_dirty_ = false;
+      replacer_->SetEvictable(frame_id, false);
+      frames.push_back(frame_id);
+    }
+  }
+
+  if (frames.empty()) {
+    return;
+  }
 
+  metrics_.RecordWriteBacks(frames.size());
+  lock->unlock();
+  std::vector<bool> failed(frames.size(), false);
+  for (size_t i = 0; i < frames.size(); i++) {
+    Page *page = &pages_[frames[i]];
+    page->RLatch();
+    try {
+      disk_manager_->WritePage(page->GetPageId(), page->GetData());
+    } catch (const Exception &e) {
+      failed[i] = true;
+    }
+    page->RUnlatch();
+  }
+  lock->lock();
+
+  // Unpin without recording an access, so that the frames keep their place in the eviction order. A page that could
+  // not be written back is dirty again.
+  for (size_t i = 0; i < frames.size(); i++) {
+    const frame_id_t frame_id = frames[i];
+    if (failed[i]) {
+      pages_[frame_id].is_dirty_ = true;
+    }
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->SetEvictable(frame_id, true);
+    }
+  }
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+void BufferPoolManagerInstance::PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) {
+  std::lock_guard<TimedMutex> lock(latch_);
+
+  frame_id_t frame_id;
+  bool admitted = false;
+  for (auto page_id : page_ids) {
+    ValidatePageId(page_id);
+    // Skip pages that are resident or being loaded already, and pages whose copy on disk is still stale.
+    if (page_table_->Find(page_id, frame_id) || write_back_pages_.count(page_id) > 0) {
+      continue;
+    }
+    if (!HasAvailableFrame()) {
+      break;
+    }
+    prefetch_queue_.push_back(AdmitPage(page_id, true, ring));
+    admitted = true;
+  }
+
+  if (!admitted) {
+    return;
+  }
+  if (!prefetch_thread_.joinable()) {
+    prefetch_thread_ = std::thread(&BufferPoolManagerInstance::BackgroundPrefetch, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::BackgroundPrefetch() {
+  std::unique_lock<TimedMutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    // The queue is drained before stopping, so that no frame is left pinned with its I/O in progress.
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    // Take the whole queue, so that the reads of one batch are in flight together.
+    std::vector<FrameIO> ios(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+
+    lock.unlock();
+    DoFrameIOs(&ios);
+    lock.lock();
+    for (const auto &io : ios) {
+      FinishFrameIO(io);
+      // Drop the pin taken by AdmitPage(). Fetchers that arrived during the read hold their own pins.
+      if (io.Failed()) {
+        UnpinFailedFrame(io.frame_id_);
+      } else if (--pages_[io.frame_id_].pin_count_ == 0) {
+        replacer_->SetEvictable(io.frame_id_, true);
+      }
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::HasAvailableFrame() -> bool {
+  // A frame with pin count 0 is either on the free list or tracked as evictable by the replacer.
+  return !free_list_.empty() || replacer_->Size() > 0;
+}
+
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  const page_id_t page_id = disk_manager_->AllocatePage(num_instances_, instance_index_);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) {
+  ValidatePageId(page_id);
+  disk_manager_->DeallocatePage(page_id);
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+}
 
 }  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace bustub {
+
+auto BufferPoolStats::operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  write_backs_ += other.write_backs_;
+  pin_waits_ += other.pin_waits_;
+  failed_fetches_ += other.failed_fetches_;
+  for (size_t i = 0; i < LATCH_HOLD_BUCKETS; i++) {
+    latch_hold_histogram_[i] += other.latch_hold_histogram_[i];
+  }
+  return *this;
+}
+
+auto BufferPoolStats::HitRatio() const -> double {
+  const uint64_t fetches = hits_ + misses_;
+  return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+}
+
+auto BufferPoolStats::LatchHolds() const -> uint64_t {
+  uint64_t holds = 0;
+  for (auto count : latch_hold_histogram_) {
+    holds += count;
+  }
+  return holds;
+}
+
+auto BufferPoolStats::LatchHoldPercentile(double percentile) const -> uint64_t {
+  const uint64_t holds = LatchHolds();
+  if (holds == 0) {
+    return 0;
+  }
+  // The rank of the percentile, counting from 1.
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100 * holds)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < LATCH_HOLD_BUCKETS; i++) {
+    seen += latch_hold_histogram_[i];
+    if (seen >= rank) {
+      return LatchHoldBucketBound(i);
+    }
+  }
+  return LatchHoldBucketBound(LATCH_HOLD_BUCKETS - 1);
+}
+
+void BufferPoolMetrics::RecordLatchHold(std::chrono::nanoseconds held) {
+  const auto ns = static_cast<uint64_t>(std::max<int64_t>(held.count(), 1));
+  // floor(log2(ns)), the last bucket also takes everything above it.
+  const auto bucket = std::min<size_t>(63 - __builtin_clzll(ns), LATCH_HOLD_BUCKETS - 1);
+  latch_hold_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+auto BufferPoolMetrics::GetStats() const -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.hits_ = hits_.load(std::memory_order_relaxed);
+  stats.misses_ = misses_.load(std::memory_order_relaxed);
+  stats.evictions_ = evictions_.load(std::memory_order_relaxed);
+  stats.write_backs_ = write_backs_.load(std::memory_order_relaxed);
+  stats.pin_waits_ = pin_waits_.load(std::memory_order_relaxed);
+  stats.failed_fetches_ = failed_fetches_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < LATCH_HOLD_BUCKETS; i++) {
+    stats.latch_hold_histogram_[i] = latch_hold_histogram_[i].load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+}  // namespace bustub
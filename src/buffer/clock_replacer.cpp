@@ -12,18 +12,94 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), states_(num_pages), referenced_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  // Without interference, the first lap clears the reference bits and the second one finds a victim.
+  while (num_evictable_.load(std::memory_order_acquire) > 0) {
+    const size_t pos = hand_.fetch_add(1, std::memory_order_relaxed) % num_pages_;
+    if (states_[pos].load(std::memory_order_relaxed) != (TRACKED | EVICTABLE)) {
+      continue;
+    }
+    if (referenced_[pos].load(std::memory_order_relaxed) != 0) {
+      referenced_[pos].store(0, std::memory_order_relaxed);
+      continue;
+    }
+    uint8_t expected = TRACKED | EVICTABLE;
+    if (states_[pos].compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+      num_evictable_.fetch_sub(1, std::memory_order_release);
+      *frame_id = static_cast<frame_id_t>(pos);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+
+  referenced_[frame_id].store(1, std::memory_order_relaxed);
+  if ((states_[frame_id].load(std::memory_order_relaxed) & TRACKED) == 0) {
+    states_[frame_id].fetch_or(TRACKED, std::memory_order_acq_rel);
+  }
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  CheckFrameId(frame_id);
+
+  const uint8_t from = set_evictable ? TRACKED : TRACKED | EVICTABLE;
+  const uint8_t to = set_evictable ? TRACKED | EVICTABLE : TRACKED;
+  // Fails if the frame is untracked or already in the requested state, which leaves it as it is.
+  uint8_t expected = from;
+  if (!states_[frame_id].compare_exchange_strong(expected, to, std::memory_order_acq_rel)) {
+    return;
+  }
+  if (set_evictable) {
+    num_evictable_.fetch_add(1, std::memory_order_release);
+  } else {
+    num_evictable_.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  CheckFrameId(frame_id);
+
+  uint8_t expected = TRACKED | EVICTABLE;
+  if (states_[frame_id].compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+    referenced_[frame_id].store(0, std::memory_order_relaxed);
+    num_evictable_.fetch_sub(1, std::memory_order_release);
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+auto ClockReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  // Evict() would take the unreferenced frames in the order of the hand during the first lap, and then the referenced
+  // ones, whose bits it cleared, in the same order during the second lap.
+  const size_t hand = hand_.load(std::memory_order_relaxed) % num_pages_;
+  std::vector<frame_id_t> candidates;
+  for (uint8_t referenced : {0, 1}) {
+    for (size_t i = 0; i < num_pages_ && candidates.size() < max_count; i++) {
+      const size_t pos = (hand + i) % num_pages_;
+      if (states_[pos].load(std::memory_order_relaxed) == (TRACKED | EVICTABLE) &&
+          referenced_[pos].load(std::memory_order_relaxed) == referenced) {
+        candidates.push_back(static_cast<frame_id_t>(pos));
+      }
+    }
+  }
+  return candidates;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::Size() -> size_t { return num_evictable_.load(std::memory_order_acquire); }
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range of the clock replacer");
+  }
+}
 
 }  // namespace bustub
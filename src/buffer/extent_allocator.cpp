@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.cpp
+//
+// Identification: src/buffer/extent_allocator.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/extent_allocator.h"
+
+namespace bustub {
+
+ExtentAllocator::ExtentAllocator(BufferPoolManager *bpm, size_t extent_size) : bpm_(bpm), extent_size_(extent_size) {
+  BUSTUB_ASSERT(extent_size > 0, "An extent needs at least one page");
+}
+
+ExtentAllocator::~ExtentAllocator() {
+  // The pages were never created, so deleting them only deallocates them.
+  for (page_id_t page_id = next_page_id_; page_id < end_page_id_; page_id++) {
+    bpm_->DeletePage(page_id);
+  }
+}
+
+auto ExtentAllocator::NewPage(page_id_t *page_id) -> Page * {
+  std::scoped_lock lock(latch_);
+  if (next_page_id_ == end_page_id_) {
+    const page_id_t first_page_id = bpm_->AllocateExtent(extent_size_);
+    if (first_page_id == INVALID_PAGE_ID) {
+      return bpm_->NewPage(page_id);
+    }
+    next_page_id_ = first_page_id;
+    end_page_id_ = first_page_id + static_cast<page_id_t>(extent_size_);
+  }
+  // Keep the page id if the page cannot be created, the next call tries it again.
+  Page *page = bpm_->NewPageInExtent(next_page_id_);
+  if (page != nullptr) {
+    *page_id = next_page_id_++;
+  }
+  return page;
+}
+
+}  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+#if defined(__linux__)
+/** Policy of mbind(2) that restricts memory to the given nodes. Spelled out to avoid depending on libnuma. */
+static constexpr int MPOL_BIND_POLICY = 2;
+#endif
+
+FrameArena::FrameArena(size_t num_frames, bool huge_pages, int numa_node) {
+  size_ = num_frames * BUSTUB_PAGE_SIZE;
+  if (size_ == 0) {
+    return;
+  }
+
+#if defined(__linux__)
+  if (huge_pages) {
+    const size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    void *data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      data_ = static_cast<char *>(data);
+      size_ = huge_size;
+      huge_pages_ = true;
+    } else {
+      LOG_WARN("No huge pages available for %zu frames, falling back to regular pages", num_frames);
+    }
+  }
+#else
+  if (huge_pages) {
+    LOG_WARN("Huge pages are only supported on Linux, using regular pages for %zu frames", num_frames);
+  }
+#endif
+
+  if (data_ == nullptr) {
+    void *data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot map the frames of the buffer pool");
+    }
+    data_ = static_cast<char *>(data);
+#if defined(__linux__)
+    // Only a hint: it fails harmlessly where transparent huge pages are not supported.
+    madvise(data_, size_, MADV_HUGEPAGE);
+#endif
+  }
+
+  BUSTUB_ASSERT(reinterpret_cast<uintptr_t>(data_) % DIRECT_IO_ALIGNMENT == 0, "Frames must be aligned for O_DIRECT");
+
+  if (numa_node >= 0) {
+#if defined(__linux__)
+    // One bit per node, the kernel reads as many words as it needs for maxnode bits.
+    unsigned long node_mask[4] = {0};  // NOLINT
+    const auto bits_per_word = static_cast<int>(8 * sizeof(node_mask[0]));
+    BUSTUB_ASSERT(numa_node < static_cast<int>(sizeof(node_mask) * 8), "NUMA node out of range");
+    node_mask[numa_node / bits_per_word] |= 1UL << (numa_node % bits_per_word);
+    if (syscall(SYS_mbind, data_, size_, MPOL_BIND_POLICY, node_mask, sizeof(node_mask) * 8, 0) != 0) {
+      LOG_WARN("Cannot bind the buffer pool to NUMA node %d", numa_node);
+    }
+#else
+    LOG_WARN("NUMA binding is only supported on Linux, not binding the buffer pool to node %d", numa_node);
+#endif
+  }
+}
+
+void FrameArena::ReleaseFrames(frame_id_t begin, frame_id_t end) {
+  const size_t granule = huge_pages_ ? HUGE_PAGE_SIZE : BUSTUB_PAGE_SIZE;
+  const size_t first = (static_cast<size_t>(begin) * BUSTUB_PAGE_SIZE + granule - 1) / granule * granule;
+  const size_t last = static_cast<size_t>(end) * BUSTUB_PAGE_SIZE / granule * granule;
+  if (first < last) {
+    // Only a hint as well: if it fails, the memory simply stays mapped.
+    madvise(data_ + first, last - first, MADV_DONTNEED);
+  }
+}
+
+FrameArena::~FrameArena() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+}  // namespace bustub
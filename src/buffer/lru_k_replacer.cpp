@@ -12,129 +12,159 @@
 
 #include "buffer/lru_k_replacer.h"
 
+#include <queue>
+#include <utility>
+
+#include "common/exception.h"
+
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : replacer_size_(num_frames), k_(k), frames_(num_frames), history_(num_frames * k) {
+  BUSTUB_ASSERT(k > 0, "LRU-k needs to look back at least one access");
+  heap_.reserve(num_frames);
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::lock_guard<std::mutex> lock(latch_);
 
-  if (curr_size_ == 0) {
+  if (heap_.empty()) {
     return false;
   }
+  *frame_id = heap_.front();
+  Forget(*frame_id);
+  return true;
+}
 
-  auto p = lru_list_.begin();
-  while (p != lru_list_.end()) {
-    if (is_evictable_map[*p]) {
-      break;
-    }
-    p++;
-  }
-  if (p != lru_list_.end()) {
-    access_count_map_.erase(*p);
-    is_evictable_map.erase(*p);
-    *frame_id = *p;
-    lru_list_.erase(p);
-    curr_size_--;
-    return true;
-  }
+auto LRUKReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
 
-  p = lru_k_list_.begin();
-  while (p != lru_k_list_.end()) {
-    if (is_evictable_map[*p]) {
-      break;
-    }
-    p++;
+  // Walk the heap best first: the next candidate is always the smallest child of a candidate taken so far.
+  std::vector<frame_id_t> candidates;
+  auto greater = [&](size_t a, size_t b) { return HeapLess(b, a); };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> frontier(greater);
+  if (!heap_.empty()) {
+    frontier.push(0);
   }
-
-  if (p != lru_k_list_.end()) {
-    access_count_map_.erase(*p);
-    is_evictable_map.erase(*p);
-    *frame_id = *p;
-    lru_k_list_.erase(p);
-    curr_size_--;
-    return true;
+  while (!frontier.empty() && candidates.size() < max_count) {
+    const size_t pos = frontier.top();
+    frontier.pop();
+    candidates.push_back(heap_[pos]);
+    for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap_.size(); child++) {
+      frontier.push(child);
+    }
   }
-
-  return false;
+  return candidates;
 }
 
 void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
   std::lock_guard<std::mutex> lock(latch_);
-
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
-  }
-
-  access_count_map_[frame_id]++;
-
-  if (access_count_map_[frame_id] == 1) {
-    lru_list_.push_back(frame_id);
-  } else if (access_count_map_[frame_id] < k_) {
-    lru_list_.remove(frame_id);
-    lru_list_.push_back(frame_id);
-  } else if (access_count_map_[frame_id] == k_) {
-    lru_list_.remove(frame_id);
-    lru_k_list_.push_back(frame_id);
-  } else {
-    lru_k_list_.remove(frame_id);
-    lru_k_list_.push_back(frame_id);
+  CheckFrameId(frame_id);
+
+  FrameInfo &frame = frames_[frame_id];
+  history_[frame_id * k_ + frame.next_slot_] = current_timestamp_++;
+  frame.next_slot_ = (frame.next_slot_ + 1) % k_;
+  frame.access_count_++;
+  UpdatePriority(frame_id);
+  if (frame.heap_pos_ != NOT_IN_HEAP) {
+    HeapFix(frame.heap_pos_);
   }
-
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
 
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
+  const FrameInfo &frame = frames_[frame_id];
+  if (frame.access_count_ == 0) {
+    return;
   }
-
-  if (is_evictable_map.find(frame_id) == is_evictable_map.end()) {
-    is_evictable_map[frame_id] = set_evictable;
-    if (set_evictable) {
-      curr_size_++;
-    }
+  const bool evictable = frame.heap_pos_ != NOT_IN_HEAP;
+  if (set_evictable && !evictable) {
+    HeapPush(frame_id);
+  } else if (!set_evictable && evictable) {
+    HeapErase(frame_id);
   }
+}
 
-  if (!is_evictable_map[frame_id]&& set_evictable) {
-    is_evictable_map[frame_id] = true;
-    curr_size_++;
-  }
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
 
-  if (is_evictable_map[frame_id] && !set_evictable) {
-    is_evictable_map[frame_id] = false;
-    curr_size_--;
+  if (frames_[frame_id].heap_pos_ == NOT_IN_HEAP) {
+    return;
   }
+  // Drop the whole access history, so that a frame reused later starts from scratch.
+  Forget(frame_id);
 }
 
-void LRUKReplacer::Remove(frame_id_t frame_id) {
+auto LRUKReplacer::Size() -> size_t {
   std::lock_guard<std::mutex> lock(latch_);
+  return heap_.size();
+}
 
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::exception();
+void LRUKReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range of the LRU-k replacer");
   }
+}
 
-  if (!is_evictable_map[frame_id]) {
-    return;
+void LRUKReplacer::UpdatePriority(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  // Until the ring is full, its oldest access is in the first slot. From then on, it is the one overwritten next, i.e.
+  // the kth latest access.
+  if (frame.access_count_ < k_) {
+    frame.priority_ = history_[frame_id * k_];
+  } else {
+    frame.priority_ = K_ACCESSES_PRIORITY + history_[frame_id * k_ + frame.next_slot_];
   }
+}
 
-  auto access_count = access_count_map_[frame_id];
+void LRUKReplacer::Forget(frame_id_t frame_id) {
+  HeapErase(frame_id);
+  frames_[frame_id] = FrameInfo{};
+}
 
-  if (access_count < k_) {
-    lru_list_.remove(frame_id);
-  } else if (access_count >= k_) {
-    lru_k_list_.remove(frame_id);
-  }
+void LRUKReplacer::HeapPush(frame_id_t frame_id) {
+  frames_[frame_id].heap_pos_ = heap_.size();
+  heap_.push_back(frame_id);
+  HeapFix(heap_.size() - 1);
+}
 
-  access_count_map_[frame_id]--;
-  if (access_count_map_[frame_id] == 0) {
-    access_count_map_.erase(frame_id);
+void LRUKReplacer::HeapErase(frame_id_t frame_id) {
+  const size_t pos = frames_[frame_id].heap_pos_;
+  HeapSwap(pos, heap_.size() - 1);
+  heap_.pop_back();
+  frames_[frame_id].heap_pos_ = NOT_IN_HEAP;
+  if (pos < heap_.size()) {
+    HeapFix(pos);
   }
+}
 
-  curr_size_--;
+void LRUKReplacer::HeapFix(size_t pos) {
+  while (pos > 0 && HeapLess(pos, (pos - 1) / 2)) {
+    HeapSwap(pos, (pos - 1) / 2);
+    pos = (pos - 1) / 2;
+  }
+  while (true) {
+    size_t smallest = pos;
+    for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap_.size(); child++) {
+      if (HeapLess(child, smallest)) {
+        smallest = child;
+      }
+    }
+    if (smallest == pos) {
+      return;
+    }
+    HeapSwap(pos, smallest);
+    pos = smallest;
+  }
 }
 
-auto LRUKReplacer::Size() -> size_t { return curr_size_; }
+void LRUKReplacer::HeapSwap(size_t a, size_t b) {
+  std::swap(heap_[a], heap_[b]);
+  frames_[heap_[a]].heap_pos_ = a;
+  frames_[heap_[b]].heap_pos_ = b;
+}
 
 }  // namespace bustub
@@ -12,18 +12,99 @@
 
 #include "buffer/lru_replacer.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : num_pages_(num_pages), frames_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  if (num_evictable_ == 0) {
+    return false;
+  }
+  for (auto it = lru_list_.rbegin(); it != lru_list_.rend(); ++it) {
+    if (frames_[*it].evictable_) {
+      *frame_id = *it;
+      Forget(*frame_id);
+      return true;
+    }
+  }
+  UNREACHABLE("an evictable frame is always in the list");
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.tracked_) {
+    lru_list_.splice(lru_list_.begin(), lru_list_, frame.pos_);
+    return;
+  }
+  lru_list_.push_front(frame_id);
+  frame.pos_ = lru_list_.begin();
+  frame.tracked_ = true;
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  FrameInfo &frame = frames_[frame_id];
+  if (!frame.tracked_ || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  if (set_evictable) {
+    num_evictable_++;
+  } else {
+    num_evictable_--;
+  }
+}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  if (frames_[frame_id].evictable_) {
+    Forget(frame_id);
+  }
+}
+
+auto LRUReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  std::vector<frame_id_t> candidates;
+  for (auto it = lru_list_.rbegin(); it != lru_list_.rend() && candidates.size() < max_count; ++it) {
+    if (frames_[*it].evictable_) {
+      candidates.push_back(*it);
+    }
+  }
+  return candidates;
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+auto LRUReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return num_evictable_;
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range of the LRU replacer");
+  }
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::Forget(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  lru_list_.erase(frame.pos_);
+  if (frame.evictable_) {
+    num_evictable_--;
+  }
+  frame = FrameInfo{};
+}
 
 }  // namespace bustub
@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  // Keep the load factor at or below 1/2, so that probe sequences stay short and always end at an empty slot.
+  uint32_t bits = 1;
+  while ((static_cast<size_t>(1) << bits) < 2 * num_frames) {
+    bits++;
+  }
+  mask_ = (static_cast<size_t>(1) << bits) - 1;
+  shift_ = 64 - bits;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(mask_ + 1);
+  for (size_t i = 0; i <= mask_; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Probe(page_id_t page_id) const -> size_t {
+  size_t index = HomeSlot(page_id);
+  // A consistent table always has an empty slot. The bound only matters for a reader racing with a writer, whose
+  // result is thrown away anyway.
+  for (size_t i = 0; i <= mask_; i++) {
+    const uint64_t slot = slots_[index].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || PageOf(slot) == page_id) {
+      return index;
+    }
+    index = (index + 1) & mask_;
+  }
+  return index;
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t &frame_id) const -> bool {
+  while (true) {
+    const uint64_t version = version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      continue;
+    }
+    const uint64_t slot = slots_[Probe(page_id)].load(std::memory_order_relaxed);
+    // Order the slot reads before re-reading the version, as in a seqlock.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) != version) {
+      continue;
+    }
+    if (slot == EMPTY_SLOT || PageOf(slot) != page_id) {
+      return false;
+    }
+    frame_id = FrameOf(slot);
+    return true;
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "Cannot map an invalid page id");
+  std::lock_guard<std::mutex> lock(write_latch_);
+
+  const size_t index = Probe(page_id);
+  const bool is_new = slots_[index].load(std::memory_order_relaxed) == EMPTY_SLOT;
+  BUSTUB_ASSERT(!is_new || 2 * (Size() + 1) <= GetCapacity(), "Page table holds more pages than frames");
+
+  const uint64_t version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slots_[index].store(Pack(page_id, frame_id), std::memory_order_relaxed);
+  version_.store(version + 2, std::memory_order_release);
+
+  if (is_new) {
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  std::lock_guard<std::mutex> lock(write_latch_);
+
+  size_t hole = Probe(page_id);
+  if (slots_[hole].load(std::memory_order_relaxed) == EMPTY_SLOT) {
+    return false;
+  }
+
+  const uint64_t version = version_.load(std::memory_order_relaxed);
+  version_.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // Backward shift deletion: move every later entry of the cluster whose home slot is not between the hole and the
+  // entry into the hole, so that no probe sequence is broken.
+  size_t index = hole;
+  while (true) {
+    index = (index + 1) & mask_;
+    const uint64_t slot = slots_[index].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    const size_t home = HomeSlot(PageOf(slot));
+    const bool stays = hole <= index ? (hole < home && home <= index) : (hole < home || home <= index);
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_relaxed);
+      hole = index;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_relaxed);
+
+  version_.store(version + 2, std::memory_order_release);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager,
+                                                     size_t max_pool_size, ReplacerPolicy replacer_policy)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel BPM needs at least one instance");
+
+  // Allocate and create the individual BufferPoolManagerInstances.
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager, max_pool_size, replacer_policy));
+  }
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::Resize(size_t pool_size) -> bool {
+  const size_t num_instances = instances_.size();
+  if (pool_size < num_instances) {
+    return false;
+  }
+  // The first pool_size % num_instances instances get one frame more.
+  auto instance_size = [&](size_t i) { return pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0); };
+  for (size_t i = 0; i < num_instances; i++) {
+    if (instance_size(i) >= instances_[i]->GetPoolSize() && !instances_[i]->Resize(instance_size(i))) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < num_instances; i++) {
+    if (instance_size(i) < instances_[i]->GetPoolSize() && !instances_[i]->Resize(instance_size(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto ParallelBufferPoolManager::SetReplacerPolicy(ReplacerPolicy policy) -> bool {
+  for (auto &instance : instances_) {
+    instance->SetReplacerPolicy(policy);
+  }
+  return true;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::SetAccessTrace(AccessTrace *trace) {
+  for (auto &instance : instances_) {
+    instance->SetAccessTrace(trace);
+  }
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(size_t clean_frames) {
+  for (auto &instance : instances_) {
+    instance->StartBackgroundFlusher(clean_frames);
+  }
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id >= 0, "Cannot route an invalid page id to a buffer pool instance");
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+auto ParallelBufferPoolManager::FetchPgBulkImp(page_id_t page_id, BufferRing *ring) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPageBulk(page_id, ring);
+}
+
+auto ParallelBufferPoolManager::FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  // Per instance, the page ids of its batch and where each of them goes in the result.
+  std::vector<std::vector<page_id_t>> batches(instances_.size());
+  std::vector<std::vector<size_t>> positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    BUSTUB_ASSERT(page_ids[i] >= 0, "Cannot route an invalid page id to a buffer pool instance");
+    const size_t instance_index = static_cast<size_t>(page_ids[i]) % instances_.size();
+    batches[instance_index].push_back(page_ids[i]);
+    positions[instance_index].push_back(i);
+  }
+
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (batches[i].empty()) {
+      continue;
+    }
+    auto batch_pages = instances_[i]->FetchPages(batches[i]);
+    for (size_t j = 0; j < batch_pages.size(); j++) {
+      pages[positions[i][j]] = batch_pages[j];
+    }
+  }
+  return pages;
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  // Each call starts one instance further along, so consecutive new pages are spread over all the shards.
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1, std::memory_order_relaxed) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    Page *page = instances_[(start + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::AllocateExtentImp(size_t num_pages) -> page_id_t {
+  return disk_manager_->AllocateExtent(num_pages);
+}
+
+auto ParallelBufferPoolManager::NewPgInExtentImp(page_id_t page_id) -> Page * {
+  return GetBufferPoolManager(page_id)->NewPageInExtent(page_id);
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  for (auto &instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+void ParallelBufferPoolManager::PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) {
+  std::vector<std::vector<page_id_t>> batches(instances_.size());
+  for (auto page_id : page_ids) {
+    BUSTUB_ASSERT(page_id >= 0, "Cannot route an invalid page id to a buffer pool instance");
+    batches[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!batches[i].empty()) {
+      instances_[i]->PrefetchPages(batches[i], ring);
+    }
+  }
+}
+
+}  // namespace bustub
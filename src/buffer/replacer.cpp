@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer.cpp
+//
+// Identification: src/buffer/replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_q_replacer.h"
+#include "common/macros.h"
+#include "common/util/string_util.h"
+
+namespace bustub {
+
+auto CreateReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> Replacer * {
+  switch (policy) {
+    case ReplacerPolicy::LRU:
+      return new LRUReplacer(num_frames);
+    case ReplacerPolicy::CLOCK:
+      return new ClockReplacer(num_frames);
+    case ReplacerPolicy::LRU_K:
+      return new LRUKReplacer(num_frames, k);
+    case ReplacerPolicy::ARC:
+      return new ArcReplacer(num_frames);
+    case ReplacerPolicy::TWO_Q:
+      return new TwoQReplacer(num_frames);
+  }
+  UNREACHABLE("unknown replacer policy");
+}
+
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string {
+  switch (policy) {
+    case ReplacerPolicy::LRU:
+      return "lru";
+    case ReplacerPolicy::CLOCK:
+      return "clock";
+    case ReplacerPolicy::LRU_K:
+      return "lru-k";
+    case ReplacerPolicy::ARC:
+      return "arc";
+    case ReplacerPolicy::TWO_Q:
+      return "2q";
+  }
+  UNREACHABLE("unknown replacer policy");
+}
+
+auto ParseReplacerPolicy(const std::string &name, ReplacerPolicy *policy) -> bool {
+  const std::string lower_name = StringUtil::Lower(name);
+  for (auto candidate : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::LRU_K, ReplacerPolicy::ARC,
+                         ReplacerPolicy::TWO_Q}) {
+    if (ReplacerPolicyToString(candidate) == lower_name) {
+      *policy = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
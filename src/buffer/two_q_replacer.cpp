@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.cpp
+//
+// Identification: src/buffer/two_q_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames) : num_frames_(num_frames), frames_(num_frames) {}
+
+auto TwoQReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  if (a1in_evictable_ + am_evictable_ == 0) {
+    return false;
+  }
+  const bool from_a1in = EvictFromA1in(a1in_.size(), a1in_evictable_, am_evictable_);
+  auto &queue = from_a1in ? a1in_ : am_;
+  auto victim = std::find_if(queue.rbegin(), queue.rend(), [&](frame_id_t id) { return frames_[id].evictable_; });
+  BUSTUB_ASSERT(victim != queue.rend(), "an evictable frame is always in its queue");
+
+  *frame_id = *victim;
+  const page_id_t page_id = frames_[*frame_id].page_id_;
+  Forget(*frame_id);
+  if (from_a1in && page_id != INVALID_PAGE_ID) {
+    a1out_.push_front(page_id);
+    a1out_index_[page_id] = a1out_.begin();
+    const size_t max_a1out_size = std::max<size_t>(1, capacity_ / 2);
+    while (a1out_.size() > max_a1out_size) {
+      a1out_index_.erase(a1out_.back());
+      a1out_.pop_back();
+    }
+  }
+  return true;
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.list_ == TwoQList::AM) {
+    am_.splice(am_.begin(), am_, frame.pos_);
+    return;
+  }
+  if (frame.list_ == TwoQList::A1IN) {
+    // Accesses to a page in A1in are correlated with its first one, and do not count.
+    return;
+  }
+
+  TwoQList list = TwoQList::A1IN;
+  auto ghost = a1out_index_.find(frame.page_id_);
+  if (ghost != a1out_index_.end()) {
+    a1out_.erase(ghost->second);
+    a1out_index_.erase(ghost);
+    list = TwoQList::AM;
+  }
+  auto &queue = Queue(list);
+  queue.push_front(frame_id);
+  frame.pos_ = queue.begin();
+  frame.list_ = list;
+  capacity_ = std::max(capacity_, a1in_.size() + am_.size());
+}
+
+void TwoQReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+  frames_[frame_id].page_id_ = page_id;
+}
+
+void TwoQReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  FrameInfo &frame = frames_[frame_id];
+  if (frame.list_ == TwoQList::NONE || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  size_t &evictable = frame.list_ == TwoQList::A1IN ? a1in_evictable_ : am_evictable_;
+  if (set_evictable) {
+    evictable++;
+  } else {
+    evictable--;
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  CheckFrameId(frame_id);
+
+  // The page is gone rather than evicted, so it does not go to A1out.
+  if (frames_[frame_id].evictable_) {
+    Forget(frame_id);
+  }
+}
+
+auto TwoQReplacer::EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> lock(latch_);
+
+  // Replay Evict() on copies of the queue sizes, walking both queues from their cold end.
+  std::vector<frame_id_t> candidates;
+  size_t a1in_size = a1in_.size();
+  size_t a1in_evictable = a1in_evictable_;
+  size_t am_evictable = am_evictable_;
+  auto a1in_it = a1in_.rbegin();
+  auto am_it = am_.rbegin();
+  while (candidates.size() < max_count && a1in_evictable + am_evictable > 0) {
+    const bool from_a1in = EvictFromA1in(a1in_size, a1in_evictable, am_evictable);
+    auto &it = from_a1in ? a1in_it : am_it;
+    while (!frames_[*it].evictable_) {
+      ++it;
+    }
+    candidates.push_back(*it++);
+    if (from_a1in) {
+      a1in_size--;
+      a1in_evictable--;
+    } else {
+      am_evictable--;
+    }
+  }
+  return candidates;
+}
+
+auto TwoQReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock(latch_);
+  return a1in_evictable_ + am_evictable_;
+}
+
+void TwoQReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range of the 2Q replacer");
+  }
+}
+
+auto TwoQReplacer::EvictFromA1in(size_t a1in_size, size_t a1in_evictable, size_t am_evictable) const -> bool {
+  const size_t max_a1in_size = std::max<size_t>(1, capacity_ / 4);
+  return a1in_evictable > 0 && (a1in_size > max_a1in_size || am_evictable == 0);
+}
+
+void TwoQReplacer::Forget(frame_id_t frame_id) {
+  FrameInfo &frame = frames_[frame_id];
+  Queue(frame.list_).erase(frame.pos_);
+  if (frame.evictable_) {
+    (frame.list_ == TwoQList::A1IN ? a1in_evictable_ : am_evictable_)--;
+  }
+  frame = FrameInfo{};
+}
+
+}  // namespace bustub
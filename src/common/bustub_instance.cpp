@@ -1,3 +1,4 @@
+#include <fstream>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -11,7 +12,9 @@
 #include "binder/statement/index_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
+#include "buffer/access_trace.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
@@ -51,9 +54,16 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`, split evenly across BUFFER_POOL_INSTANCES shards. The pool can be
+  // resized up to BUFFER_POOL_MAX_SIZE frames with `SET buffer_pool_size`, and its replacement policy switched with
+  // `SET buffer_pool_replacer`.
+  // Dirty pages are written back in the background, so that queries rarely wait for a write on a miss.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    auto *buffer_pool_manager =
+        new ParallelBufferPoolManager(BUFFER_POOL_INSTANCES, 128 / BUFFER_POOL_INSTANCES, disk_manager_,
+                                      LRUK_REPLACER_K, log_manager_, BUFFER_POOL_MAX_SIZE / BUFFER_POOL_INSTANCES);
+    buffer_pool_manager->StartBackgroundFlusher(128 / BUFFER_POOL_INSTANCES / 4);
+    buffer_pool_manager_ = buffer_pool_manager;
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -83,9 +93,13 @@ BustubInstance::BustubInstance() {
   log_manager_ = new LogManager(disk_manager_);
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // buffer pool size specified in `config.h`, split evenly across BUFFER_POOL_INSTANCES shards. The pool can be
+  // resized up to BUFFER_POOL_MAX_SIZE frames with `SET buffer_pool_size`, and its replacement policy switched with
+  // `SET buffer_pool_replacer`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ =
+        new ParallelBufferPoolManager(BUFFER_POOL_INSTANCES, 128 / BUFFER_POOL_INSTANCES, disk_manager_,
+                                      LRUK_REPLACER_K, log_manager_, BUFFER_POOL_MAX_SIZE / BUFFER_POOL_INSTANCES);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -159,6 +173,9 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\bpstats: show the buffer pool counters
+\bptrace start: start recording buffer pool accesses
+\bptrace stop <file>: stop recording and write the accesses to a file
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -172,6 +189,106 @@ see the execution plan of your query.
   WriteOneCell(help, writer);
 }
 
+void BustubInstance::CmdDisplayBufferPoolStats(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception("buffer pool manager is not available");
+  }
+  const auto stats = buffer_pool_manager_->GetStats();
+  std::vector<std::pair<std::string, std::string>> rows{
+      {"hits", fmt::format("{}", stats.hits_)},
+      {"misses", fmt::format("{}", stats.misses_)},
+      {"hit_ratio", fmt::format("{:.4f}", stats.HitRatio())},
+      {"evictions", fmt::format("{}", stats.evictions_)},
+      {"write_backs", fmt::format("{}", stats.write_backs_)},
+      {"pin_waits", fmt::format("{}", stats.pin_waits_)},
+      {"failed_fetches", fmt::format("{}", stats.failed_fetches_)},
+      {"latch_holds", fmt::format("{}", stats.LatchHolds())},
+      {"latch_hold_p50_ns", fmt::format("<{}", stats.LatchHoldPercentile(50))},
+      {"latch_hold_p99_ns", fmt::format("<{}", stats.LatchHoldPercentile(99))},
+  };
+  for (size_t i = 0; i < LATCH_HOLD_BUCKETS; i++) {
+    if (stats.latch_hold_histogram_[i] > 0) {
+      rows.emplace_back(fmt::format("latch_hold_ns<{}", BufferPoolStats::LatchHoldBucketBound(i)),
+                        fmt::format("{}", stats.latch_hold_histogram_[i]));
+    }
+  }
+
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("metric");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[metric, value] : rows) {
+    writer.BeginRow();
+    writer.WriteCell(metric);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
+void BustubInstance::CmdBufferPoolTrace(const std::string &args, ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception("buffer pool manager is not available");
+  }
+
+  if (args == "start") {
+    // The trace is never freed while the buffer pool is alive, since fetches that raced with a stop may still be
+    // recording into it. Restarting only forgets what was recorded so far.
+    if (access_trace_ == nullptr) {
+      access_trace_ = std::make_unique<AccessTrace>();
+    }
+    access_trace_->Clear();
+    buffer_pool_manager_->SetAccessTrace(access_trace_.get());
+    WriteOneCell(fmt::format("Recording the last {} buffer pool accesses", access_trace_->GetCapacity()), writer);
+    return;
+  }
+
+  if (StringUtil::StartsWith(args, "stop ") && access_trace_ != nullptr) {
+    buffer_pool_manager_->SetAccessTrace(nullptr);
+    const auto file_name = args.substr(std::string("stop ").size());
+    std::ofstream file(file_name);
+    if (!file) {
+      throw Exception(fmt::format("cannot open trace file: {}", file_name));
+    }
+    const size_t num_written = access_trace_->WriteTo(file);
+    WriteOneCell(fmt::format("Wrote {} buffer pool accesses to {}", num_written, file_name), writer);
+    return;
+  }
+
+  throw Exception("usage: \\bptrace start | \\bptrace stop <file>");
+}
+
+void BustubInstance::SetBufferPoolSize(const std::string &value) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception("buffer pool manager is not available");
+  }
+  size_t pool_size = 0;
+  try {
+    pool_size = std::stoull(value);
+  } catch (std::logic_error &e) {
+    throw Exception(fmt::format("invalid buffer_pool_size: {}", value));
+  }
+  if (!buffer_pool_manager_->Resize(pool_size)) {
+    throw Exception(fmt::format("cannot resize the buffer pool to {} frames, the size must be between {} and {} and "
+                                "the frames that go away must not be pinned",
+                                pool_size, BUFFER_POOL_INSTANCES, BUFFER_POOL_MAX_SIZE));
+  }
+}
+
+void BustubInstance::SetBufferPoolReplacer(const std::string &value) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception("buffer pool manager is not available");
+  }
+  ReplacerPolicy policy;
+  if (!ParseReplacerPolicy(value, &policy)) {
+    throw Exception(fmt::format("invalid buffer_pool_replacer: {}, expected lru, clock, lru-k, arc or 2q", value));
+  }
+  if (!buffer_pool_manager_->SetReplacerPolicy(policy)) {
+    throw Exception(fmt::format("cannot switch the buffer pool to the {} replacer", value));
+  }
+}
+
 auto BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) -> bool {
   auto txn = txn_manager_->Begin();
   auto result = ExecuteSqlTxn(sql, writer, txn);
@@ -195,6 +312,16 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayHelp(writer);
       return true;
     }
+    if (sql == "\\bpstats") {
+      CmdDisplayBufferPoolStats(writer);
+      return true;
+    }
+    if (sql == "\\bptrace" || StringUtil::StartsWith(sql, "\\bptrace ")) {
+      auto args = sql.substr(std::string("\\bptrace").size());
+      args.erase(0, args.find_first_not_of(' '));
+      CmdBufferPoolTrace(args, writer);
+      return true;
+    }
     throw Exception(fmt::format("unsupported internal command: {}", sql));
   }
 
@@ -252,11 +379,23 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
         auto content = GetSessionVariable(show_stmt.variable_);
+        if (show_stmt.variable_ == "buffer_pool_size" && buffer_pool_manager_ != nullptr) {
+          content = fmt::format("{}", buffer_pool_manager_->GetPoolSize());
+        }
+        if (show_stmt.variable_ == "buffer_pool_replacer" && buffer_pool_manager_ != nullptr) {
+          content = ReplacerPolicyToString(buffer_pool_manager_->GetReplacerPolicy());
+        }
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
       }
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
+        if (set_stmt.variable_ == "buffer_pool_size") {
+          SetBufferPoolSize(set_stmt.value_);
+        }
+        if (set_stmt.variable_ == "buffer_pool_replacer") {
+          SetBufferPoolReplacer(set_stmt.value_);
+        }
         session_variables_[set_stmt.variable_] = set_stmt.value_;
         continue;
       }
@@ -20,4 +20,12 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds background_flush_interval = std::chrono::milliseconds(10);
+
+std::atomic<bool> buffer_pool_huge_pages(false);
+
+std::atomic<int> buffer_pool_numa_node(-1);
+
+std::atomic<bool> enable_page_checksums(true);
+
 }  // namespace bustub
@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The CRC-32C polynomial, bit-reversed. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+constexpr auto MakeTable() -> std::array<uint32_t, 256> {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = MakeTable();
+
+/**
+ * ZerosTable shifts a CRC register over a fixed number of zero bytes, which is how the CRCs of adjacent blocks that
+ * were computed independently are combined: crc(A + B) = shift(crc(A), |B|) ^ crc(B), with crc(B) started from 0.
+ * See Mark Adler's answer on https://stackoverflow.com/questions/17645167.
+ */
+class ZerosTable {
+ public:
+  /** @param length the number of zero bytes, a power of two */
+  explicit ZerosTable(size_t length) {
+    // The operator for one zero bit, as the images of the 32 unit vectors, then squared up to length zero bytes.
+    std::array<uint32_t, 32> op{};
+    op[0] = CRC32C_POLYNOMIAL;
+    for (int n = 1; n < 32; n++) {
+      op[n] = 1U << (n - 1);
+    }
+    for (size_t bits = 1; bits < length * 8; bits *= 2) {
+      std::array<uint32_t, 32> square{};
+      for (int n = 0; n < 32; n++) {
+        square[n] = Apply(op, op[n]);
+      }
+      op = square;
+    }
+    for (uint32_t n = 0; n < 256; n++) {
+      for (int byte = 0; byte < 4; byte++) {
+        table_[byte][n] = Apply(op, n << (8 * byte));
+      }
+    }
+  }
+
+  auto Shift(uint32_t crc) const -> uint32_t {
+    return table_[0][crc & 0xFF] ^ table_[1][(crc >> 8) & 0xFF] ^ table_[2][(crc >> 16) & 0xFF] ^ table_[3][crc >> 24];
+  }
+
+ private:
+  /** Multiply a 32x32 matrix over GF(2) with a vector. */
+  static auto Apply(const std::array<uint32_t, 32> &matrix, uint32_t vector) -> uint32_t {
+    uint32_t sum = 0;
+    for (int n = 0; vector != 0; n++, vector >>= 1) {
+      if ((vector & 1) != 0) {
+        sum ^= matrix[n];
+      }
+    }
+    return sum;
+  }
+
+  uint32_t table_[4][256];
+};
+
+#if defined(__x86_64__)
+/** Block sizes of the three interleaved crc32 streams. A page is one round of each, plus a 256 byte tail. */
+constexpr size_t CRC32C_LONG_BLOCK = 1024;
+constexpr size_t CRC32C_SHORT_BLOCK = 256;
+
+/**
+ * Compute the CRC over three adjacent blocks at once, and combine the three CRCs. The crc32 instruction takes three
+ * cycles but can start every cycle, so three independent streams run three times as fast as one.
+ */
+__attribute__((target("sse4.2"))) inline auto ComputeBlocks(const char **data, size_t *length, uint64_t crc,
+                                                             size_t block, const ZerosTable &zeros) -> uint64_t {
+  while (*length >= 3 * block) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (size_t i = 0; i < block; i += sizeof(uint64_t)) {
+      uint64_t words[3];
+      memcpy(&words[0], *data + i, sizeof(uint64_t));
+      memcpy(&words[1], *data + block + i, sizeof(uint64_t));
+      memcpy(&words[2], *data + 2 * block + i, sizeof(uint64_t));
+      crc = _mm_crc32_u64(crc, words[0]);
+      crc1 = _mm_crc32_u64(crc1, words[1]);
+      crc2 = _mm_crc32_u64(crc2, words[2]);
+    }
+    crc = zeros.Shift(static_cast<uint32_t>(crc)) ^ crc1;
+    crc = zeros.Shift(static_cast<uint32_t>(crc)) ^ crc2;
+    *data += 3 * block;
+    *length -= 3 * block;
+  }
+  return crc;
+}
+
+// Compiled for SSE4.2 regardless of the build flags, and only called once the CPU is known to support it.
+__attribute__((target("sse4.2"))) auto ComputeHardware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  static const ZerosTable long_zeros(CRC32C_LONG_BLOCK);
+  static const ZerosTable short_zeros(CRC32C_SHORT_BLOCK);
+  uint64_t crc64 = ~crc;
+  crc64 = ComputeBlocks(&data, &length, crc64, CRC32C_LONG_BLOCK, long_zeros);
+  crc64 = ComputeBlocks(&data, &length, crc64, CRC32C_SHORT_BLOCK, short_zeros);
+  for (; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; length > 0; data++, length--) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+#endif
+
+}  // namespace
+
+auto Crc32c::HasHardwareSupport() -> bool {
+#if defined(__x86_64__)
+  static const bool has_sse42 = __builtin_cpu_supports("sse4.2");
+  return has_sse42;
+#else
+  return false;
+#endif
+}
+
+auto Crc32c::Compute(const char *data, size_t length, uint32_t crc) -> uint32_t {
+#if defined(__x86_64__)
+  if (HasHardwareSupport()) {
+    return ComputeHardware(data, length, crc);
+  }
+#endif
+  return ComputeSoftware(data, length, crc);
+}
+
+auto Crc32c::ComputeSoftware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF];
+  }
+  return ~crc;
+}
+
+}  // namespace bustub
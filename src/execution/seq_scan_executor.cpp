@@ -14,10 +14,29 @@
 
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
 
-void SeqScanExecutor::Init() { throw NotImplementedException("SeqScanExecutor is not implemented"); }
+void SeqScanExecutor::Init() {
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  iterator_ = std::make_unique<TableIterator>(table_info_->table_->Begin(exec_ctx_->GetTransaction(), &ring_));
+}
 
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (*iterator_ != table_info_->table_->End()) {
+    *tuple = **iterator_;
+    *rid = tuple->GetRid();
+    ++(*iterator_);
+    const auto &filter_expr = plan_->filter_predicate_;
+    if (filter_expr == nullptr) {
+      return true;
+    }
+    auto value = filter_expr->Evaluate(tuple, GetOutputSchema());
+    if (!value.IsNull() && value.GetAs<bool>()) {
+      return true;
+    }
+  }
+  return false;
+}
 
 }  // namespace bustub
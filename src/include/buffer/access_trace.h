@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_trace.h
+//
+// Identification: src/include/buffer/access_trace.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The kind of a page access recorded in an AccessTrace. */
+enum class AccessType : uint8_t { FETCH = 0, NEW = 1, DELETE = 2 };
+
+/** One page access recorded in an AccessTrace. */
+struct AccessRecord {
+  AccessType type_;
+  page_id_t page_id_;
+
+  auto operator==(const AccessRecord &other) const -> bool {
+    return type_ == other.type_ && page_id_ == other.page_id_;
+  }
+};
+
+/**
+ * AccessTrace records the most recent page accesses of a buffer pool in a fixed-size ring, so that they can be written
+ * out and replayed offline against different replacers.
+ *
+ * Recording is lock-free: each access claims the next sequence number with one atomic increment and stores itself,
+ * tagged with that number, into its slot with one atomic store. Readers skip the slots whose tag does not match the
+ * sequence number they expect, i.e. records that are still being written or have been overwritten already.
+ */
+class AccessTrace {
+ public:
+  /**
+   * @brief Create a new AccessTrace.
+   * @param capacity the number of most recent accesses to keep
+   */
+  explicit AccessTrace(size_t capacity = ACCESS_TRACE_CAPACITY);
+
+  /**
+   * @brief Record a page access. Safe to call from any number of threads.
+   * @param type the kind of access
+   * @param page_id the page that was accessed
+   */
+  void Record(AccessType type, page_id_t page_id) {
+    const uint64_t seq = next_.fetch_add(1, std::memory_order_relaxed);
+    slots_[seq % slots_.size()].store(Pack(seq, type, page_id), std::memory_order_relaxed);
+  }
+
+  /** @brief Forget the accesses recorded so far. */
+  void Clear() { start_.store(next_.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+  /** @return the number of accesses the trace keeps */
+  auto GetCapacity() const -> size_t { return slots_.size(); }
+
+  /** @return the number of accesses recorded since the trace was created or cleared, including overwritten ones */
+  auto GetNumRecorded() const -> uint64_t {
+    return next_.load(std::memory_order_relaxed) - start_.load(std::memory_order_relaxed);
+  }
+
+  /** @return the kept accesses, oldest first */
+  auto Snapshot() const -> std::vector<AccessRecord>;
+
+  /**
+   * @brief Write the kept accesses as text, oldest first and one per line: 'F', 'N' or 'D' for a fetch, new page or
+   * delete, followed by the page id.
+   * @param os the stream to write to
+   * @return the number of accesses written
+   */
+  auto WriteTo(std::ostream &os) const -> size_t;
+
+  /**
+   * @brief Read a trace written by WriteTo(). Empty lines and lines starting with '#' are skipped.
+   * @param is the stream to read from
+   * @return the accesses, in the order they were written
+   */
+  static auto ReadFrom(std::istream &is) -> std::vector<AccessRecord>;
+
+ private:
+  /** Bits of a slot taken by the sequence number tag, the remaining 34 bits hold the page id and the access type. */
+  static constexpr int SEQ_BITS = 30;
+
+  /** Tag the record with seq + 1, so that a slot that was never written (0) matches no sequence number. */
+  static auto Pack(uint64_t seq, AccessType type, page_id_t page_id) -> uint64_t {
+    return ((seq + 1) << (64 - SEQ_BITS)) | (static_cast<uint64_t>(type) << 32) | static_cast<uint32_t>(page_id);
+  }
+
+  std::vector<std::atomic<uint64_t>> slots_;
+  /** The sequence number of the next access. */
+  std::atomic<uint64_t> next_{0};
+  /** The sequence number of the first access after the last Clear(). */
+  std::atomic<uint64_t> start_{0};
+};
+
+}  // namespace bustub
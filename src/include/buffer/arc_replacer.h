@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ArcReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * The resident frames are split into T1, the frames whose page was accessed once since it was loaded, and T2, the
+ * frames whose page was accessed more often, both in LRU order. The pages recently evicted from T1 and T2 are
+ * remembered in the ghost lists B1 and B2. A page that comes back while it is in B1 means that T1 was too small, and one
+ * in B2 that T2 was too small, so ARC moves its target size p for T1 accordingly. Evict() takes the LRU frame of T1 if
+ * T1 holds more than p frames, and the LRU frame of T2 otherwise. A one-time scan therefore only ever flushes T1.
+ *
+ * The buffer pool has to tell the replacer which page a frame holds with SetPageId(), since frame ids are reused. The
+ * cache size c that bounds p and the ghost lists is the largest number of frames tracked at the same time, i.e. the
+ * pool size once the pool has filled up. Non-evictable frames stay in their list, and Evict() skips them.
+ */
+class ArcReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ArcReplacer.
+   * @param num_frames the maximum number of frames the ArcReplacer will be required to store
+   */
+  explicit ArcReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ArcReplacer);
+
+  ~ArcReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+  /** @return the current target size of T1, for tests */
+  auto GetTargetT1Size() -> size_t;
+
+ private:
+  /** The list a frame or a ghost page is in. */
+  enum class ArcList { NONE, T1, T2, B1, B2 };
+
+  /** What the replacer knows about a frame. */
+  struct FrameInfo {
+    ArcList list_{ArcList::NONE};
+    bool evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** Position of the frame in t1_ or t2_, if it is tracked. */
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** A page in one of the ghost lists. */
+  struct GhostInfo {
+    ArcList list_;
+    std::list<page_id_t>::iterator pos_;
+  };
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @brief Whether the next victim comes from T1, given the size of T1 and the evictable frames in T1 and T2. */
+  auto EvictFromT1(size_t t1_size, size_t t1_evictable, size_t t2_evictable) const -> bool;
+
+  /** @brief Stop tracking a frame. */
+  void Forget(frame_id_t frame_id);
+
+  /** @brief Remember an evicted page in B1 or B2, and trim the ghost lists to their bounds. */
+  void AddGhost(page_id_t page_id, ArcList list);
+
+  void EraseGhost(page_id_t page_id);
+
+  auto ResidentList(ArcList list) -> std::list<frame_id_t> & { return list == ArcList::T1 ? t1_ : t2_; }
+
+  size_t num_frames_;
+  /** c, the largest number of frames tracked so far. */
+  size_t capacity_{0};
+  /** p, the target size of T1. */
+  size_t target_t1_size_{0};
+
+  std::mutex latch_;
+
+  /** Per frame, what the replacer knows about it. */
+  std::vector<FrameInfo> frames_;
+  /** The resident frames, most recently accessed first. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** The number of evictable frames in t1_ and in t2_. */
+  size_t t1_evictable_{0};
+  size_t t2_evictable_{0};
+
+  /** The ghost pages, most recently evicted first. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  std::unordered_map<page_id_t, GhostInfo> ghosts_;
+};
+
+}  // namespace bustub
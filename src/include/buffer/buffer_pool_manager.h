@@ -15,11 +15,16 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/access_trace.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/buffer_ring.h"
+#include "buffer/replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -84,9 +89,112 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetch a page and hand its pin to a guard, which unpins the page when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @return the guard, which is empty (!IsValid()) if page_id cannot be fetched
+   */
+  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+
+  /**
+   * Fetch a page and read latch it. The guard releases the latch and unpins the page when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @return the guard, which is empty (!IsValid()) if page_id cannot be fetched
+   */
+  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard { return FetchPageBasic(page_id).UpgradeRead(); }
+
+  /**
+   * Fetch a page and write latch it. The guard releases the latch and unpins the page when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @return the guard, which is empty (!IsValid()) if page_id cannot be fetched
+   */
+  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard { return FetchPageBasic(page_id).UpgradeWrite(); }
+
+  /**
+   * Create a new page and hand its pin to a guard, which unpins the page when it goes out of scope.
+   * @param[out] page_id id of created page
+   * @return the guard, which is empty (!IsValid()) if no new page could be created
+   */
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
+
+  /**
+   * Reserve an extent: num_pages page ids that are contiguous on disk. The pages are created one at a time with
+   * NewPageInExtent(), so that a table or index that grows page by page still ends up with long runs of neighboring
+   * pages, which scans and read-ahead read with few, large I/Os.
+   * @param num_pages number of pages in the extent
+   * @return the first page id of the extent, or INVALID_PAGE_ID if the buffer pool does not support extents
+   */
+  auto AllocateExtent(size_t num_pages) -> page_id_t { return AllocateExtentImp(num_pages); }
+
+  /**
+   * Create a new page like NewPage(), with a page id from an extent that AllocateExtent() reserved.
+   * @param page_id id of the page, which must be reserved and not created yet
+   * @return nullptr if no new page could be created, e.g. because it is in the buffer pool already, otherwise pointer
+   * to new page
+   */
+  auto NewPageInExtent(page_id_t page_id) -> Page * { return NewPgInExtentImp(page_id); }
+
+  /**
+   * Fetch a page for a bulk read, like a large sequential scan. On a miss, the page is loaded into one of the frames
+   * of the ring rather than into a frame picked from the whole pool. Unpin it with UnpinPage() as usual.
+   * @param page_id id of page to be fetched
+   * @param ring the ring of the bulk read, nullptr to fetch like FetchPage()
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPageBulk(page_id_t page_id, BufferRing *ring) -> Page * { return FetchPgBulkImp(page_id, ring); }
+
+  /**
+   * Fetch several pages at once, e.g. all the pages that the probes of an index join need. Each page is pinned once per
+   * time its id appears. Unpin them with UnpinPage() as usual.
+   * @param page_ids ids of the pages to fetch
+   * @return the pages, in the order of page_ids. An entry is nullptr if that page cannot be fetched, the others are
+   * fetched (and must be unpinned) nonetheless.
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> { return FetchPgsImp(page_ids); }
+
+  /**
+   * Hint that the given pages will be fetched soon. Pages that are not in the buffer pool are read in the background,
+   * so that a later FetchPage() finds them resident. This is only a hint: it never blocks on the reads, and pages for
+   * which no frame can be made available are skipped.
+   * @param page_ids ids of the pages to read ahead, in the order they are expected to be fetched
+   * @param ring the ring to read the pages into if they are going to be fetched with FetchPageBulk(), else nullptr
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferRing *ring = nullptr) {
+    PrefetchPgsImp(page_ids, ring);
+  }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * Grow or shrink the buffer pool while it is in use. Buffer pools that cannot be resized always fail.
+   * @param pool_size the new number of frames
+   * @return false if the buffer pool cannot be resized to pool_size, true otherwise
+   */
+  virtual auto Resize(__attribute__((unused)) size_t pool_size) -> bool { return false; }
+
+  /**
+   * Switch to another replacement policy while the buffer pool is in use. Buffer pools without a replacer always fail.
+   * @param policy the new replacement policy
+   * @return false if the buffer pool cannot switch to policy, true otherwise
+   */
+  virtual auto SetReplacerPolicy(__attribute__((unused)) ReplacerPolicy policy) -> bool { return false; }
+
+  /** @return the replacement policy of the buffer pool, LRU-K for buffer pools without a replacer */
+  virtual auto GetReplacerPolicy() -> ReplacerPolicy { return ReplacerPolicy::LRU_K; }
+
+  /**
+   * Read the counters of the buffer pool, without taking its latch. Buffer pools without metrics return all zeros.
+   * @return a snapshot of the counters
+   */
+  virtual auto GetStats() -> BufferPoolStats { return {}; }
+
+  /**
+   * Start or stop recording the page accesses of the buffer pool. Buffer pools without tracing ignore the trace.
+   * @param trace the trace to record into, which must outlive the buffer pool, or nullptr to stop recording
+   */
+  virtual void SetAccessTrace(__attribute__((unused)) AccessTrace *trace) {}
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -141,6 +249,52 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Fetches the requested page for a bulk read. Buffer pools without bulk read strategies fetch it as usual.
+   * @param page_id id of page to be fetched
+   * @param ring the ring of the bulk read, or nullptr
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  virtual auto FetchPgBulkImp(page_id_t page_id, __attribute__((unused)) BufferRing *ring) -> Page * {
+    return FetchPgImp(page_id);
+  }
+
+  /**
+   * Fetches several pages at once. Buffer pools without batched fetches fetch them one by one.
+   * @param page_ids ids of the pages to fetch
+   * @return the pages, nullptr for those that cannot be fetched
+   */
+  virtual auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+    std::vector<Page *> pages;
+    pages.reserve(page_ids.size());
+    for (auto page_id : page_ids) {
+      pages.push_back(FetchPgImp(page_id));
+    }
+    return pages;
+  }
+
+  /**
+   * Reads the given pages into the buffer pool in the background. Buffer pools without read-ahead ignore the hint.
+   * @param page_ids ids of the pages to read ahead
+   * @param ring the ring to read the pages into, or nullptr
+   */
+  virtual void PrefetchPgsImp(__attribute__((unused)) const std::vector<page_id_t> &page_ids,
+                              __attribute__((unused)) BufferRing *ring) {}
+
+  /**
+   * Reserves an extent of contiguous page ids. Buffer pools without extents reserve none.
+   * @param num_pages number of pages in the extent
+   * @return the first page id of the extent, or INVALID_PAGE_ID
+   */
+  virtual auto AllocateExtentImp(__attribute__((unused)) size_t num_pages) -> page_id_t { return INVALID_PAGE_ID; }
+
+  /**
+   * Creates a new page with a page id from a reserved extent.
+   * @param page_id id of the page
+   * @return nullptr if no new page could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgInExtentImp(__attribute__((unused)) page_id_t page_id) -> Page * { return nullptr; }
 };
 
 }  // namespace bustub
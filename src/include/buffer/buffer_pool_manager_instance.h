@@ -12,14 +12,22 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/access_trace.h"
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -37,9 +45,28 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param max_pool_size the size that Resize() can grow the buffer pool to, 0 for pool_size
+   * @param replacer_policy the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, size_t max_pool_size = 0,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param max_pool_size the size that Resize() can grow the buffer pool to, 0 for pool_size
+   * @param replacer_policy the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, size_t max_pool_size = 0,
+                            ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -49,9 +76,61 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
+  /** @brief Return the size that the buffer pool can be grown to. */
+  auto GetMaxPoolSize() const -> size_t { return max_pool_size_; }
+
+  /**
+   * @brief Grow or shrink the buffer pool while it is in use.
+   *
+   * The metadata and the memory of max_pool_size frames are reserved up front, so a resize never moves a page that is
+   * in use: frame i is always at GetPages()[i]. Growing puts frames [pool_size, new size) on the free list. Shrinking
+   * takes frames [new size, pool_size) out of use and gives their memory back to the OS. The pages in those frames
+   * move to free frames that stay, and once there are none left, they are evicted (dirty ones are written back while
+   * holding the latch). Shrinking fails without any change if one of the frames that go away is pinned, or if a page
+   * that would be evicted cannot be written back.
+   *
+   * @param pool_size the new number of frames, between 1 and max_pool_size
+   * @return false if the buffer pool cannot be resized to pool_size, true otherwise
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  /**
+   * @brief Switch to another replacement policy while the buffer pool is in use.
+   *
+   * The new replacer starts out tracking every page in the buffer pool with a single access, in frame order, so the
+   * access history gathered by the old replacer is lost.
+   *
+   * @param policy the new replacement policy
+   * @return always true
+   */
+  auto SetReplacerPolicy(ReplacerPolicy policy) -> bool override;
+
+  /** @brief Return the current replacement policy. */
+  auto GetReplacerPolicy() -> ReplacerPolicy override;
+
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /**
+   * @brief Start a background thread that writes back dirty frames before they are evicted.
+   *
+   * Every background_flush_interval, or sooner when a miss had to write back a dirty victim, the flusher looks at the
+   * next clean_frames victims of the replacer and writes the dirty ones to disk without holding the buffer pool latch.
+   * Misses then rarely have to pay for a write. The thread is stopped when the buffer pool is destroyed.
+   *
+   * @param clean_frames the number of next-to-be-evicted frames that the flusher tries to keep clean
+   */
+  void StartBackgroundFlusher(size_t clean_frames);
+
+  /** @brief Read the counters of this instance, without taking its latch. */
+  auto GetStats() -> BufferPoolStats override { return metrics_.GetStats(); }
+
+  /**
+   * @brief Start or stop recording the fetches, new pages and deletes of this instance.
+   * @param trace the trace to record into, which must outlive the buffer pool, or nullptr to stop recording
+   */
+  void SetAccessTrace(AccessTrace *trace) override { access_trace_.store(trace, std::memory_order_relaxed); }
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -72,6 +151,22 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * @brief Reserve an extent of contiguous page ids on disk. Its pages map to every instance of a parallel BPM, which
+   * share the disk manager, so any of them can reserve it.
+   * @param num_pages number of pages in the extent
+   * @return the first page id of the extent
+   */
+  auto AllocateExtentImp(size_t num_pages) -> page_id_t override;
+
+  /**
+   * @brief Create a new page like NewPgImp(), with a page id that AllocateExtentImp() reserved. A page that is in the
+   * buffer pool already was created before, and is left alone.
+   * @param page_id id of the page
+   * @return nullptr if no new page could be created or the page is in the buffer pool, otherwise pointer to new page
+   */
+  auto NewPgInExtentImp(page_id_t page_id) -> Page * override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -90,6 +185,28 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * @brief Fetch the requested page like FetchPgImp(), except that on a miss the page is loaded into the next frame of
+   * the ring. The ring first claims regular frames until it is full, and from then on reuses its own frames.
+   *
+   * @param page_id id of page to be fetched
+   * @param ring the ring of the bulk read, nullptr to pick the frame from the whole pool
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgBulkImp(page_id_t page_id, BufferRing *ring) -> Page * override;
+
+  /**
+   * @brief Fetch several pages with a single acquisition of the latch.
+   *
+   * Pages that are resident are pinned right away. Frames are admitted for the others while the latch is held, then
+   * their victims are written back and the pages are read in page id order, without the latch. Pages whose eviction is
+   * still being written back are fetched one by one at the end.
+   *
+   * @param page_ids ids of the pages to fetch
+   * @return the pages, in the order of page_ids, nullptr for those that cannot be fetched
+   */
+  auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
   /**
    * TODO(P1): Add implementation
    *
@@ -111,74 +228,260 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @brief Flush the target page to disk.
    *
    * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
-   * Unset the dirty flag of the page after flushing.
+   * Unset the dirty flag of the page after flushing. A page that could not be written stays dirty.
    *
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @return false if the page could not be found in the page table or could not be written, true otherwise
    */
   auto FlushPgImp(page_id_t page_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the pages in the buffer pool to disk. The pages that could not be written stay dirty.
    */
   void FlushAllPgsImp() override;
 
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Delete a page from the buffer pool. If page_id is not in the buffer pool, do nothing and return true. If the
-   * page is pinned and cannot be deleted, return false immediately.
+   * @brief Delete a page from the buffer pool and deallocate it on disk. If page_id is not in the buffer pool, only
+   * deallocate it and return true. If the page is pinned and cannot be deleted, return false immediately.
    *
    * After deleting the page from the page table, stop tracking the frame in the replacer and add the frame
-   * back to the free list. Also, reset the page's memory and metadata. Finally, you should call DeallocatePage() to
-   * imitate freeing the page on the disk.
+   * back to the free list. Also, reset the page's memory and metadata. Finally, release the latch and call
+   * DeallocatePage() to free the page on the disk, which does disk I/O. The page must not be fetched concurrently.
    *
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
+  /**
+   * @brief Read the given pages into the buffer pool in the background.
+   *
+   * Pages that are not resident are put into free or evicted frames right away, exactly like a fetch would, but without
+   * a pin for the caller. The prefetch thread (started on first use) then writes back their dirty victims and reads
+   * them in without the latch. A fetch that arrives while the read is in flight waits for it instead of issuing its
+   * own. Once read, the frames become evictable again.
+   *
+   * @param page_ids ids of the pages to read ahead
+   * @param ring the ring to read the pages into, or nullptr
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) override;
+
+  /** Number of pages in the buffer pool, i.e. frames [0, pool_size_) are in use. Changed by Resize() with latch_. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames that the buffer pool reserves metadata and memory for. */
+  const size_t max_pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
 
-  /** Array of buffer pool pages. */
+  /** Array of all max_pool_size_ frames. Only holds the metadata of each frame, the data lives in frame_arena_. */
   Page *pages_;
+  /** The data of all the frames. */
+  FrameArena *frame_arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_;
 
   /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  PageTable *page_table_;
 
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  Replacer *replacer_;
+  /** The policy of replacer_. */
+  ReplacerPolicy replacer_policy_;
+  /** The lookback constant k for LRU-K replacers. */
+  const size_t replacer_k_;
 
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
 
+  /** Counters of this instance, see GetStats(). Declared before latch_, which records its hold times here. */
+  BufferPoolMetrics metrics_;
+  /** The trace that accesses are recorded into, or nullptr. */
+  std::atomic<AccessTrace *> access_trace_{nullptr};
+
   /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  TimedMutex latch_{&metrics_};
+
+  /** Per frame, true while the frame is read from or written to disk without the latch. Protected by latch_. */
+  std::vector<bool> io_in_progress_;
+  /** Per frame, notified when its I/O completes. Waited on with latch_. */
+  std::vector<std::condition_variable_any> io_cv_;
+  /** Evicted pages whose write back is still in flight, so their copy on disk is stale. Protected by latch_. */
+  std::unordered_set<page_id_t> write_back_pages_;
+  /** Notified whenever a write back completes. Waited on with latch_. */
+  std::condition_variable_any write_back_cv_;
+
+  /** The I/O needed to put a page into a frame: the write back of the frame's dirty victim, then the read. */
+  struct FrameIO {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+    page_id_t evicted_page_id_;
+    bool write_back_;
+    bool read_page_;
+    /** Set by DoFrameIO() if the page could not be read, because the disk manager found it corrupt. */
+    bool read_failed_{false};
+    /** Set by DoFrameIO() if the victim could not be written back, e.g. because the database file is read-only. */
+    bool write_failed_{false};
+
+    /** @return true if the page did not make it into the frame */
+    auto Failed() const -> bool { return read_failed_ || write_failed_; }
+  };
+
+  /** Prefetch thread, only running after the first PrefetchPgsImp() that had pages to read. */
+  std::thread prefetch_thread_;
+  /** Admitted pages that the prefetch thread has yet to read in. Protected by latch_. */
+  std::deque<FrameIO> prefetch_queue_;
+  /** Set to stop the prefetch thread once its queue is drained. Protected by latch_. */
+  bool prefetch_stop_{false};
+  /** Wakes up the prefetch thread, waited on with latch_. */
+  std::condition_variable_any prefetch_cv_;
+
+  /** Background flusher thread, only running after StartBackgroundFlusher(). */
+  std::thread flush_thread_;
+  /** Number of next-to-be-evicted frames that the flusher keeps clean. Protected by latch_. */
+  size_t flush_clean_frames_{0};
+  /** Set to stop the background flusher. Protected by latch_. */
+  bool flush_stop_{false};
+  /** Wakes up the background flusher, waited on with latch_. */
+  std::condition_variable_any flush_cv_;
+
+  /**
+   * @brief Record an access in the access trace, if there is one.
+   * @param type the kind of access
+   * @param page_id the page that was accessed
+   */
+  void TraceAccess(AccessType type, page_id_t page_id) {
+    AccessTrace *trace = access_trace_.load(std::memory_order_relaxed);
+    if (trace != nullptr) {
+      trace->Record(type, page_id);
+    }
+  }
+
+  /**
+   * @brief Main loop of the background flusher thread.
+   */
+  void BackgroundFlush();
+
+  /**
+   * @brief Write back the dirty frames among the next victims of the replacer. The frames are pinned while they are
+   * being written, so that they cannot be evicted or reused once the latch is released for the I/O.
+   * @param lock the held lock on latch_, which is released during the writes and re-acquired before returning
+   */
+  void FlushVictims(std::unique_lock<TimedMutex> *lock);
+
+  /**
+   * @brief Main loop of the prefetch thread.
+   */
+  void BackgroundPrefetch();
+
+  /**
+   * @brief Map page_id to a free or evicted frame, pinned once. Caller should acquire the latch before calling this
+   * function, and make sure that a frame is available.
+   *
+   * If the frame needs I/O, it is marked as I/O in progress, and the caller must run DoFrameIO() without the latch
+   * and FinishFrameIO() with the latch afterwards.
+   *
+   * @param page_id id of the page to admit
+   * @param read_page true to read the page from disk, false to zero it (for a new page)
+   * @param ring the ring to take the frame from, or nullptr
+   * @return the I/O to do for the frame
+   */
+  auto AdmitPage(page_id_t page_id, bool read_page, BufferRing *ring) -> FrameIO;
+
+  /**
+   * @brief Take a frame for page_id out of the free list or the replacer, or reuse the next frame of the ring. Caller
+   * should acquire the latch before calling this function, and make sure that a frame is available.
+   * @param page_id id of the page that is going to be put into the frame
+   * @param ring the ring to take the frame from, or nullptr
+   * @return the frame, which is neither on the free list nor tracked by the replacer anymore
+   */
+  auto TakeFrame(page_id_t page_id, BufferRing *ring) -> frame_id_t;
+
+  /**
+   * @brief Write back the victim and read in the page of an admitted frame. Called without the latch.
+   * @param[in,out] io the I/O returned by AdmitPage(), whose write_failed_ or read_failed_ is set if the write back or
+   * the read throws. The page is not read after a failed write back, the frame still holds the victim.
+   */
+  void DoFrameIO(FrameIO *io);
+
+  /**
+   * @brief Do the I/O of several admitted frames, like DoFrameIO(). All the write backs are started before waiting for
+   * any of them, then all the reads, so that a disk manager with asynchronous I/O has them in flight together.
+   * Called without the latch.
+   * @param[in,out] ios the I/O returned by AdmitPage() for each frame
+   */
+  void DoFrameIOs(std::vector<FrameIO> *ios);
+
+  /**
+   * @brief Mark the I/O of an admitted frame as complete and wake up its waiters. Caller should acquire the latch.
+   *
+   * If the read failed, the page is taken out of the page table and the frame holds INVALID_PAGE_ID, which tells the
+   * pinned waiters to give up. If the write back failed, the eviction is rolled back: the victim is mapped to the frame
+   * again, still dirty, and the waiters give up just the same. Each pin holder, including the caller, then drops its
+   * pin with UnpinFailedFrame().
+   *
+   * @param io the I/O done by DoFrameIO()
+   */
+  void FinishFrameIO(const FrameIO &io);
+
+  /**
+   * @brief Drop a pin on a frame whose I/O failed. Once the last pin is gone, the frame is freed, or made evictable if
+   * it went back to its victim. Caller should acquire the latch.
+   * @param frame_id the frame
+   */
+  void UnpinFailedFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Put page_id into a free or evicted frame, pinned once. Caller should acquire the latch before calling this
+   * function, and make sure that a frame is available.
+   *
+   * The latch is released while a dirty victim is written back and while the page is read from disk. During that time
+   * the frame is marked as I/O in progress: fetchers of page_id wait on the frame's condition variable, and fetchers of
+   * the victim page wait until it is written back.
+   *
+   * @param page_id id of the page to load
+   * @param read_page true to read the page from disk, false to zero it (for a new page)
+   * @param ring the ring to take the frame from, or nullptr
+   * @param lock the held lock on latch_, which is held again when this function returns
+   * @return pointer to the loaded page, or nullptr if the disk manager found the page corrupt
+   */
+  auto LoadPage(page_id_t page_id, bool read_page, BufferRing *ring, std::unique_lock<TimedMutex> *lock) -> Page *;
+
+  /**
+   * @brief Check in O(1) whether a frame can be handed out, i.e. some frame is free or evictable. Caller should acquire
+   * the latch before calling this function.
+   * @return true if the free list is not empty or the replacer has an evictable frame
+   */
+  auto HasAvailableFrame() -> bool;
 
   /**
    * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * The disk manager hands out the lowest free page id of the stripe instance_index_, instance_index_ + num_instances_,
+   * ..., so every id allocated here maps back to this instance, and the ids of deleted pages are reused.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions
+   * to validate input data and ensure that a parallel BPM is routing requests to the correct BPI.
+   * @param page_id the page id to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * @brief Deallocate a page on disk, so that AllocatePage() can reuse its id. This does disk I/O, so the caller should
+   * release the latch before calling this function, and make sure that no I/O of the page is in flight.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
 
   // TODO(student): You may add additional private members and helper functions
 };
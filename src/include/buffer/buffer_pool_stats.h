@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+/** Number of buckets of the latch hold time histogram. Bucket i counts the holds of [2^i, 2^(i+1)) ns. */
+static constexpr size_t LATCH_HOLD_BUCKETS = 32;
+
+/**
+ * BufferPoolStats is a snapshot of the counters of a buffer pool, as returned by BufferPoolManager::GetStats().
+ */
+struct BufferPoolStats {
+  /** Fetches that found the page in the buffer pool. */
+  uint64_t hits_{0};
+  /** Fetches that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages that were evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Dirty pages that were written back on eviction or by the background flusher. */
+  uint64_t write_backs_{0};
+  /** Fetches that had to wait for the page to be read in or written back by another thread. */
+  uint64_t pin_waits_{0};
+  /** Fetches and new pages that returned nullptr because every frame was pinned. */
+  uint64_t failed_fetches_{0};
+  /** How long the buffer pool latch was held each time, see LATCH_HOLD_BUCKETS. */
+  std::array<uint64_t, LATCH_HOLD_BUCKETS> latch_hold_histogram_{};
+
+  /** @brief Add the counters of another buffer pool, e.g. of another instance of a parallel buffer pool. */
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats &;
+
+  /** @return the fraction of fetches that were hits, 0 if there were no fetches */
+  auto HitRatio() const -> double;
+
+  /** @return the number of times the latch was held */
+  auto LatchHolds() const -> uint64_t;
+
+  /**
+   * @brief Estimate a percentile of the latch hold times from the histogram.
+   * @param percentile the percentile, between 0 and 100
+   * @return the upper bound in ns of the bucket that the percentile falls into, 0 if the latch was never held
+   */
+  auto LatchHoldPercentile(double percentile) const -> uint64_t;
+
+  /** @return the (exclusive) upper bound in ns of the given bucket of the latch hold time histogram */
+  static auto LatchHoldBucketBound(size_t bucket) -> uint64_t { return uint64_t{1} << (bucket + 1); }
+};
+
+/**
+ * BufferPoolMetrics holds the live counters of a buffer pool instance. They are updated with relaxed atomic increments,
+ * so that GetStats() can read them at any time without taking the buffer pool latch.
+ */
+class BufferPoolMetrics {
+ public:
+  void RecordHit() { hits_.fetch_add(1, std::memory_order_relaxed); }
+  void RecordMiss() { misses_.fetch_add(1, std::memory_order_relaxed); }
+  void RecordEviction() { evictions_.fetch_add(1, std::memory_order_relaxed); }
+  void RecordWriteBacks(uint64_t count) { write_backs_.fetch_add(count, std::memory_order_relaxed); }
+  void RecordPinWait() { pin_waits_.fetch_add(1, std::memory_order_relaxed); }
+  void RecordFailedFetch() { failed_fetches_.fetch_add(1, std::memory_order_relaxed); }
+
+  /** @brief Count one hold of the buffer pool latch in the histogram. */
+  void RecordLatchHold(std::chrono::nanoseconds held);
+
+  /** @return a snapshot of the counters. Counters that are updated concurrently may be slightly out of sync. */
+  auto GetStats() const -> BufferPoolStats;
+
+ private:
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> write_backs_{0};
+  std::atomic<uint64_t> pin_waits_{0};
+  std::atomic<uint64_t> failed_fetches_{0};
+  std::array<std::atomic<uint64_t>, LATCH_HOLD_BUCKETS> latch_hold_histogram_{};
+};
+
+/**
+ * TimedMutex is a mutex that records in BufferPoolMetrics how long it was held each time it is unlocked. It is
+ * BasicLockable, so it works with std::lock_guard, std::unique_lock and std::condition_variable_any. Waiting on a
+ * condition variable unlocks it, so the wait does not count as holding it.
+ */
+class TimedMutex {
+ public:
+  /**
+   * @brief Create a new TimedMutex.
+   * @param metrics the metrics to record the hold times in
+   */
+  explicit TimedMutex(BufferPoolMetrics *metrics) : metrics_(metrics) {}
+
+  void lock() {  // NOLINT
+    mutex_.lock();
+    locked_at_ = std::chrono::steady_clock::now();
+  }
+
+  void unlock() {  // NOLINT
+    const auto held = std::chrono::steady_clock::now() - locked_at_;
+    mutex_.unlock();
+    metrics_->RecordLatchHold(held);
+  }
+
+ private:
+  std::mutex mutex_;
+  /** When the mutex was locked, only accessed by its holder. */
+  std::chrono::steady_clock::time_point locked_at_;
+  BufferPoolMetrics *metrics_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_ring.h
+//
+// Identification: src/include/buffer/buffer_ring.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferRing is the bulk read strategy of a large sequential scan.
+ *
+ * Pages that miss while being fetched through a ring are loaded into a small set of frames that the ring cycles
+ * through, instead of evicting whatever the replacer picks from the whole pool. A scan over a table much larger than
+ * the buffer pool therefore only ever claims a few frames, and the pages of concurrent queries stay resident.
+ *
+ * A ring frame is only reused while it still holds the page the ring put there and nobody has it pinned. Otherwise the
+ * ring gives it up to the pool and takes a regular frame instead. Pages that are already resident are fetched as usual.
+ *
+ * A ring belongs to a single scan and must not be shared between threads.
+ */
+class BufferRing {
+  friend class BufferPoolManagerInstance;
+
+ public:
+  /**
+   * @brief Creates a new BufferRing.
+   * @param ring_size the maximum number of frames the ring claims in each buffer pool instance. Each instance caps it
+   * at an eighth of its frames, but always allows two, so that a scan can read one page ahead.
+   */
+  explicit BufferRing(size_t ring_size = BUFFER_RING_SIZE) : ring_size_(ring_size) {}
+
+  /** @brief Return the maximum number of frames the ring claims in each buffer pool instance. */
+  auto GetRingSize() const -> size_t { return ring_size_; }
+
+ private:
+  /** The frames of the ring in one buffer pool instance. */
+  struct Slots {
+    /** The frames, each with the page the ring last loaded into it. */
+    std::vector<std::pair<frame_id_t, page_id_t>> frames_;
+    /** Index of the frame to reuse next. */
+    size_t next_{0};
+  };
+
+  /** Maximum number of frames per buffer pool instance. */
+  const size_t ring_size_;
+  /** The frames of the ring, indexed by buffer pool instance. */
+  std::vector<Slots> slots_;
+};
+
+}  // namespace bustub
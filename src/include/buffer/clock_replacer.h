@@ -12,17 +12,26 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has a reference bit that is set on each access. Evict() sweeps a hand over the frames: an evictable frame
+ * with its reference bit set gets a second chance and has the bit cleared, the first one without it is the victim.
+ *
+ * The replacer takes no lock. Reference bits are plain relaxed stores, so recording a hit never contends. Whether a
+ * frame is tracked and evictable lives in one atomic byte per frame that changes by compare-and-swap, and evicting
+ * threads claim the frames to look at by advancing the hand atomically. A frame is only evicted by the thread whose
+ * compare-and-swap takes it from evictable to untracked, so concurrent evictions never return the same frame.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +41,43 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  /** The candidates are only exact while no other thread uses the replacer. */
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  /** Bits of a frame's state. A frame that is not tracked has state 0. */
+  static constexpr uint8_t TRACKED = 1;
+  static constexpr uint8_t EVICTABLE = 2;
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  size_t num_pages_;
+  /** Per frame, TRACKED and EVICTABLE bits. */
+  std::vector<std::atomic<uint8_t>> states_;
+  /** Per frame, 1 if the frame was accessed since the hand last passed it. */
+  std::vector<std::atomic<uint8_t>> referenced_;
+  /** The number of frames the hand has advanced, the frame it points at is hand_ % num_pages_. */
+  std::atomic<size_t> hand_{0};
+  /** The number of evictable frames. */
+  std::atomic<size_t> num_evictable_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.h
+//
+// Identification: src/include/buffer/extent_allocator.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/page.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+/**
+ * ExtentAllocator creates the pages of one table heap or index in extents of contiguous page ids.
+ *
+ * Allocated one at a time, the pages of a table would be interleaved with those of every other table that grows at the
+ * same time, and a scan would read them with one small random I/O each. An ExtentAllocator reserves extent_size pages
+ * at once with BufferPoolManager::AllocateExtent(), and hands them out in order, so the pages of its owner are in long
+ * runs that scans and read-ahead read sequentially.
+ *
+ * The pages of the current extent that were never created are deallocated again when the allocator is destroyed.
+ * Buffer pools without extents fall back to NewPage().
+ */
+class ExtentAllocator {
+ public:
+  /**
+   * @brief Creates a new ExtentAllocator.
+   * @param bpm the buffer pool to create the pages in
+   * @param extent_size the number of pages reserved at a time
+   */
+  explicit ExtentAllocator(BufferPoolManager *bpm, size_t extent_size = EXTENT_SIZE);
+
+  DISALLOW_COPY_AND_MOVE(ExtentAllocator);
+
+  /** @brief Deallocate the pages of the current extent that were not created. */
+  ~ExtentAllocator();
+
+  /**
+   * @brief Create a new page in the current extent, after reserving a new extent if the current one is used up.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new page could be created, otherwise pointer to new page, which is pinned
+   */
+  auto NewPage(page_id_t *page_id) -> Page *;
+
+  /**
+   * @brief Create a new page like NewPage(), and hand its pin to a guard.
+   * @param[out] page_id id of created page
+   * @return the guard, which is empty (!IsValid()) if no new page could be created
+   */
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {bpm_, NewPage(page_id)}; }
+
+ private:
+  /** The buffer pool to create the pages in. */
+  BufferPoolManager *bpm_;
+  /** The number of pages reserved at a time. */
+  const size_t extent_size_;
+  /** The next page id of the current extent to create a page with. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** One past the last page id of the current extent. */
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+  /** Protects next_page_id_ and end_page_id_, for owners that create pages from several threads. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
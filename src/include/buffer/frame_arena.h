@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+static_assert(BUSTUB_PAGE_SIZE % DIRECT_IO_ALIGNMENT == 0, "Frames must stay aligned for O_DIRECT");
+
+/**
+ * FrameArena is the memory that holds the data of all the frames of a buffer pool, as one mmap-ed region.
+ *
+ * Keeping the data apart from the Page metadata makes every frame start on an OS page boundary, as O_DIRECT requires,
+ * and keeps the metadata of neighboring frames in neighboring cache lines. The region is zero-filled on demand by the
+ * kernel, so building a large pool does not touch all of its memory up front, and room that a pool reserves to grow into
+ * costs nothing until it is used.
+ *
+ * With buffer_pool_huge_pages set, the arena tries explicit huge pages first and falls back to regular pages if none
+ * are reserved. Otherwise it asks for transparent huge pages. Either way, large pools take far fewer TLB entries. With
+ * buffer_pool_numa_node set, the arena is bound to that node. Huge pages and NUMA binding are Linux-only; elsewhere the
+ * arena is a plain anonymous mapping.
+ */
+class FrameArena {
+ public:
+  /** Size of an explicit huge page, which the arena is rounded up to when it uses them. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /**
+   * @brief Map the memory for the given number of frames.
+   * @param num_frames the number of frames
+   * @param huge_pages true to try explicit huge pages first
+   * @param numa_node the NUMA node to bind the memory to, or -1 for none
+   */
+  explicit FrameArena(size_t num_frames, bool huge_pages = buffer_pool_huge_pages,
+                      int numa_node = buffer_pool_numa_node);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /**
+   * @brief Unmap the memory of all the frames.
+   */
+  ~FrameArena();
+
+  /** @return the data of the given frame, BUSTUB_PAGE_SIZE bytes aligned to an OS page, and so to DIRECT_IO_ALIGNMENT */
+  auto GetFrameData(frame_id_t frame_id) -> char * {
+    return data_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /**
+   * @brief Give the memory of a range of frames back to the OS. The frames read as zeros when they are used again.
+   * With explicit huge pages, only the huge pages that lie entirely within the range are given back.
+   * @param begin the first frame of the range
+   * @param end one past the last frame of the range
+   */
+  void ReleaseFrames(frame_id_t begin, frame_id_t end);
+
+  /** @return true if the arena is backed by explicit huge pages */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+ private:
+  /** Start of the mapped region. */
+  char *data_{nullptr};
+  /** Size of the mapped region in bytes. */
+  size_t size_{0};
+  /** True if the region is backed by explicit huge pages. */
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
@@ -12,12 +12,12 @@
 
 #pragma once
 
+#include <cstdint>
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -32,31 +32,30 @@ namespace bustub {
  *
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
- * classical LRU algorithm is used to choose victim.
+ * the frame with the earliest access overall is chosen as victim.
+ *
+ * Each frame keeps the timestamps of its last k accesses in a ring, in one flat array for all frames. The evictable
+ * frames sit in a binary min-heap keyed by their eviction priority, which only changes when the frame is accessed, and
+ * each frame knows its position in the heap. RecordAccess() is O(1) for a pinned frame, and O(log n) otherwise. Evict(),
+ * SetEvictable() and Remove() are O(log n).
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
-   *
-   * TODO(P1): Add implementation
-   *
    * @brief a new LRUKReplacer.
    * @param num_frames the maximum number of frames the LRUReplacer will be required to store
+   * @param k the number of accesses that the backward k-distance looks back
    */
   explicit LRUKReplacer(size_t num_frames, size_t k);
 
   DISALLOW_COPY_AND_MOVE(LRUKReplacer);
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Find the frame with largest backward k-distance and evict that frame. Only frames
    * that are marked as 'evictable' are candidates for eviction.
    *
@@ -70,24 +69,19 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Record the event that the given frame id is accessed at current timestamp.
    * Create a new entry for access history if frame id has not been seen before.
    *
-   * If frame id is invalid (ie. larger than replacer_size_), throw an exception. You can
-   * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
+   * If frame id is invalid (ie. larger than replacer_size_), throw an exception.
    *
    * @param frame_id id of frame that received a new access.
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Toggle whether a frame is evictable or non-evictable. This function also
    * controls replacer's size. Note that size is equal to number of evictable entries.
    *
@@ -95,18 +89,16 @@ class LRUKReplacer {
    * decrement. If a frame was previously non-evictable and is to be set to evictable,
    * then size should increment.
    *
-   * If frame id is invalid, throw an exception or abort the process.
+   * If frame id is invalid, throw an exception.
    *
    * For other scenarios, this function should terminate without modifying anything.
    *
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
-   * TODO(P1): Add implementation
-   *
    * @brief Remove an evictable frame from replacer, along with its access history.
    * This function should also decrement replacer's size if removal is successful.
    *
@@ -114,43 +106,74 @@ class LRUKReplacer {
    * with largest backward k-distance. This function removes specified frame id,
    * no matter what its backward k-distance is.
    *
-   * If Remove is called on a non-evictable frame, throw an exception or abort the
-   * process.
-   *
-   * If specified frame is not found, directly return from this function.
+   * If the specified frame is not found or not evictable, directly return from this function.
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
-   * TODO(P1): Add implementation
+   * @brief Return up to max_count evictable frames, in the order in which Evict() would pick them, without evicting
+   * them or touching their access history. The background flusher uses this to find the next victims.
    *
+   * @param max_count the maximum number of frames to return
+   * @return the next eviction candidates, first victim first
+   */
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  /**
    * @brief Return replacer's size, which tracks the number of evictable frames.
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] size_t current_timestamp_{0};
-  [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
+  /** Position in heap_ of a frame that is not in the heap. */
+  static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+  /** Added to the priority of frames with k accesses, so that all frames with +inf backward k-distance come first. */
+  static constexpr uint64_t K_ACCESSES_PRIORITY = uint64_t{1} << 63;
+
+  /** What the replacer knows about a frame. */
+  struct FrameInfo {
+    /** Number of recorded accesses, 0 if the frame is not tracked. */
+    size_t access_count_{0};
+    /** Index in the frame's ring of timestamps where the next access goes. */
+    size_t next_slot_{0};
+    /** Position of the frame in heap_, or NOT_IN_HEAP if it is not evictable. */
+    size_t heap_pos_{NOT_IN_HEAP};
+    /** Smaller evicts first: the oldest access for less than k accesses, else K_ACCESSES_PRIORITY + the kth latest. */
+    uint64_t priority_{0};
+  };
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @brief Recompute the priority of a frame from its access history. */
+  void UpdatePriority(frame_id_t frame_id);
+
+  /** @brief Take a frame out of the tracked frames and forget its access history. The frame must be in the heap. */
+  void Forget(frame_id_t frame_id);
+
+  void HeapPush(frame_id_t frame_id);
+  void HeapErase(frame_id_t frame_id);
+  /** @brief Move the frame at pos up or down until the heap property holds again. */
+  void HeapFix(size_t pos);
+  void HeapSwap(size_t a, size_t b);
+  auto HeapLess(size_t a, size_t b) const -> bool { return frames_[heap_[a]].priority_ < frames_[heap_[b]].priority_; }
+
+  uint64_t current_timestamp_{0};
+  size_t replacer_size_;
+  size_t k_;
 
   std::mutex latch_;
 
-  // access count >=k, ordered by lru-k
-  std::list<frame_id_t> lru_k_list_;
-
-  // access count < k, ordered by lru
-  std::list<frame_id_t> lru_list_;
-
-  std::unordered_map<frame_id_t, size_t> access_count_map_;
-
-  std::unordered_map<frame_id_t, bool> is_evictable_map;
+  /** Per frame, what the replacer knows about it. */
+  std::vector<FrameInfo> frames_;
+  /** The timestamps of the last k accesses of each frame, frame i at [i * k, (i + 1) * k). */
+  std::vector<uint64_t> history_;
+  /** The evictable frames, as a binary min-heap on their priority. */
+  std::vector<frame_id_t> heap_;
 };
 
 }  // namespace bustub
@@ -18,11 +18,16 @@
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * The tracked frames sit in one list ordered by their latest access, including the non-evictable ones so that a frame
+ * keeps its place while it is pinned. Evict() skips the non-evictable frames at the cold end of the list, everything
+ * else is O(1).
  */
 class LRUReplacer : public Replacer {
  public:
@@ -32,21 +37,48 @@ class LRUReplacer : public Replacer {
    */
   explicit LRUReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(LRUReplacer);
+
   /**
    * Destroys the LRUReplacer.
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  /** What the replacer knows about a frame. */
+  struct FrameInfo {
+    bool tracked_{false};
+    bool evictable_{false};
+    /** Position of the frame in lru_list_, if it is tracked. */
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @brief Stop tracking a frame. */
+  void Forget(frame_id_t frame_id);
+
+  size_t num_pages_;
+  std::mutex latch_;
+  /** Per frame, what the replacer knows about it. */
+  std::vector<FrameInfo> frames_;
+  /** The tracked frames, most recently accessed first. */
+  std::list<frame_id_t> lru_list_;
+  /** The number of evictable frames. */
+  size_t num_evictable_{0};
 };
 
 }  // namespace bustub
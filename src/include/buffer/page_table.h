@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to their frames.
+ *
+ * It is an open-addressing hash table with linear probing, sized once for the number of frames so that it is never
+ * more than half full. Each slot packs a page id and a frame id into one 64-bit word, so a slot is read in one atomic
+ * load.
+ *
+ * Lookups are optimistic and never write shared memory: they read the version of the table, probe, and retry if the
+ * version changed in the meantime. Writers are serialized by a latch and bump the version to odd before and back to
+ * even after each change. Removal shifts the following entries back instead of leaving tombstones, so probe sequences
+ * stay short no matter how many pages pass through the buffer pool.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create a new PageTable.
+   * @param num_frames the maximum number of pages the table holds at the same time
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable() = default;
+
+  /**
+   * @brief Find the frame holding the given page.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page, if any
+   * @return true if the page is in the table, false otherwise
+   */
+  auto Find(page_id_t page_id, frame_id_t &frame_id) const -> bool;
+
+  /**
+   * @brief Map the given page to the given frame, overwriting any existing mapping of the page.
+   * @param page_id the page, cannot be INVALID_PAGE_ID
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove the mapping of the given page.
+   * @param page_id the page to remove
+   * @return true if the page was in the table, false otherwise
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+  /** @brief Return the number of pages in the table. */
+  auto Size() const -> size_t { return size_.load(std::memory_order_relaxed); }
+
+  /** @brief Return the number of slots of the table. */
+  auto GetCapacity() const -> size_t { return mask_ + 1; }
+
+ private:
+  /** A slot holding no page, i.e. INVALID_PAGE_ID mapped to an invalid frame. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the home slot of the page. Page ids are dense, so they are scattered by Fibonacci hashing. */
+  auto HomeSlot(page_id_t page_id) const -> size_t {
+    return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                               shift_);
+  }
+
+  /** @return the index of the slot holding the page, or the index of the empty slot ending its probe sequence. */
+  auto Probe(page_id_t page_id) const -> size_t;
+
+  /** Slot index mask, the capacity is a power of two. */
+  size_t mask_;
+  /** Shift that turns a 64-bit hash into a slot index. */
+  uint32_t shift_;
+  /** The slots of the table. */
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Number of pages in the table. */
+  std::atomic<size_t> size_{0};
+  /** Odd while a writer is changing the slots. */
+  std::atomic<uint64_t> version_{0};
+  /** Serializes writers. */
+  std::mutex write_latch_;
+};
+
+}  // namespace bustub
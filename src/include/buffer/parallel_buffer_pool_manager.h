@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the frames of the buffer pool across several BufferPoolManagerInstances.
+ *
+ * A page with id page_id always lives in instance (page_id % num_instances), so each instance only ever serializes
+ * the requests for its own pages on its own latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param max_pool_size the size that Resize() can grow each BufferPoolManagerInstance to, 0 for pool_size
+   * @param replacer_policy the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            size_t max_pool_size = 0, ReplacerPolicy replacer_policy = ReplacerPolicy::LRU_K);
+
+  DISALLOW_COPY_AND_MOVE(ParallelBufferPoolManager);
+
+  /**
+   * @brief Destroy an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override = default;
+
+  /** @brief Return the total size (number of frames) of all the buffer pool instances. */
+  auto GetPoolSize() -> size_t override;
+
+  /**
+   * @brief Resize the buffer pool instances so that they add up to pool_size frames, split as evenly as possible.
+   *
+   * Instances that grow are resized first, so that no frames go missing in between. If an instance cannot be resized,
+   * the instances resized before it keep their new size.
+   *
+   * @param pool_size the new total number of frames
+   * @return false if some instance could not be resized, true otherwise
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  /**
+   * @brief Switch every buffer pool instance to another replacement policy, see
+   * BufferPoolManagerInstance::SetReplacerPolicy().
+   * @param policy the new replacement policy
+   * @return always true
+   */
+  auto SetReplacerPolicy(ReplacerPolicy policy) -> bool override;
+
+  /** @brief Return the replacement policy, which all the buffer pool instances share. */
+  auto GetReplacerPolicy() -> ReplacerPolicy override { return instances_.front()->GetReplacerPolicy(); }
+
+  /** @brief Return the sum of the counters of all the buffer pool instances. */
+  auto GetStats() -> BufferPoolStats override;
+
+  /**
+   * @brief Start or stop recording the page accesses of all the buffer pool instances into one trace.
+   * @param trace the trace to record into, which must outlive the buffer pool, or nullptr to stop recording
+   */
+  void SetAccessTrace(AccessTrace *trace) override;
+
+  /** @brief Return the number of buffer pool instances. */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /** @brief Return the instance at the given index, for callers that need to inspect individual shards. */
+  auto GetInstance(size_t instance_index) -> BufferPoolManagerInstance * { return instances_[instance_index].get(); }
+
+  /**
+   * @brief Start the background flusher of every buffer pool instance.
+   * @param clean_frames the number of next-to-be-evicted frames that each instance tries to keep clean
+   */
+  void StartBackgroundFlusher(size_t clean_frames);
+
+ protected:
+  /**
+   * @brief Find the BufferPoolManagerInstance responsible for handling the given page id.
+   * @param page_id id of the page
+   * @return the BufferPoolManagerInstance responsible for handling the given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * @brief Fetch the requested page from the responsible buffer pool instance.
+   * @param page_id id of page to be fetched
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * @brief Fetch several pages, handing each instance one batch with the pages it is responsible for.
+   * @param page_ids ids of the pages to fetch
+   * @return the pages, in the order of page_ids, nullptr for those that cannot be fetched
+   */
+  auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * @brief Unpin the target page from the responsible buffer pool instance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * @brief Flush the target page to disk through the responsible buffer pool instance.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Create a new page in one of the buffer pool instances.
+   *
+   * Instances are tried round-robin: each call starts at the instance after the one the previous call started at,
+   * and moves on to the next instance until one of them can allocate a page or every instance has been tried.
+   *
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * @brief Reserve an extent of contiguous page ids with the shared disk manager. Its pages are spread over all the
+   * instances, so no single instance owns it.
+   * @param num_pages number of pages in the extent
+   * @return the first page id of the extent
+   */
+  auto AllocateExtentImp(size_t num_pages) -> page_id_t override;
+
+  /**
+   * @brief Create a new page with a page id from a reserved extent in the responsible buffer pool instance.
+   * @param page_id id of the page
+   * @return nullptr if no new page could be created, otherwise pointer to new page
+   */
+  auto NewPgInExtentImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * @brief Delete a page from the responsible buffer pool instance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Flush all the pages of every buffer pool instance to disk.
+   */
+  void FlushAllPgsImp() override;
+
+  /**
+   * @brief Fetch the requested page for a bulk read from the responsible buffer pool instance.
+   * @param page_id id of page to be fetched
+   * @param ring the ring of the bulk read, which has frames in every instance
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgBulkImp(page_id_t page_id, BufferRing *ring) -> Page * override;
+
+  /**
+   * @brief Read the given pages ahead, handing each instance one batch with the pages it is responsible for.
+   * @param page_ids ids of the pages to read ahead
+   * @param ring the ring to read the pages into, or nullptr
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferRing *ring) override;
+
+ private:
+  /** The disk manager that the buffer pool instances share, which reserves the extents of all of them. */
+  DiskManager *disk_manager_;
+  /** The buffer pool instances, indexed by page_id % num_instances. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The instance that the next NewPgImp() call starts from. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
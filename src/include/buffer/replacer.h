@@ -12,12 +12,22 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies that a buffer pool can be created with. */
+enum class ReplacerPolicy { LRU, CLOCK, LRU_K, ARC, TWO_Q };
+
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to evict when the buffer pool is full.
+ *
+ * The buffer pool records an access every time a frame is pinned, and marks the frame evictable once its pin count
+ * drops to zero. A frame is tracked from its first recorded access until it is evicted or removed. Only tracked,
+ * evictable frames count towards Size() and can be evicted.
  */
 class Replacer {
  public:
@@ -25,26 +35,70 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * Evict the victim frame as defined by the replacement policy, and stop tracking it.
+   * @param[out] frame_id id of frame that was evicted
+   * @return true if a victim frame was found, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to a frame, and start tracking it as non-evictable if it is not tracked yet.
+   * @param frame_id the id of the accessed frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
+
+  /**
+   * Tell the replacer which page a frame holds from now on. The buffer pool calls this when it loads a page into a
+   * frame, right before the first RecordAccess(). Policies that remember recently evicted pages (ARC, 2Q) use it to
+   * recognize a page that comes back; the others ignore it.
+   * @param frame_id the id of the frame
+   * @param page_id the id of the page that the frame holds
+   */
+  virtual void SetPageId(__attribute__((unused)) frame_id_t frame_id, __attribute__((unused)) page_id_t page_id) {}
+
+  /**
+   * Mark a tracked frame as evictable or not. Untracked frames are ignored.
+   * @param frame_id the id of the frame
+   * @param set_evictable whether the frame can be evicted
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Stop tracking an evictable frame, regardless of where the policy would rank it, e.g. because its page is deleted.
+   * Untracked and non-evictable frames are ignored.
+   * @param frame_id the id of the frame
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Return up to max_count evictable frames, in the order in which Evict() would pick them, without evicting them.
+   * @param max_count the maximum number of frames to return
+   * @return the next eviction candidates, first victim first
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of frames in the replacer that can be evicted */
   virtual auto Size() -> size_t = 0;
 };
 
+/**
+ * @brief Create a replacer for the given policy.
+ * @param policy the replacement policy
+ * @param num_frames the number of frames the replacer tracks, frame ids are in [0, num_frames)
+ * @param k the lookback constant of LRU-K, ignored by the other policies
+ * @return the new replacer, owned by the caller
+ */
+auto CreateReplacer(ReplacerPolicy policy, size_t num_frames, size_t k) -> Replacer *;
+
+/** @return the name of the policy, as accepted by ParseReplacerPolicy() */
+auto ReplacerPolicyToString(ReplacerPolicy policy) -> std::string;
+
+/**
+ * @brief Parse the name of a replacement policy: lru, clock, lru-k, arc or 2q, in any case.
+ * @param name the name of the policy
+ * @param[out] policy the policy
+ * @return false if name is not a known policy, true otherwise
+ */
+auto ParseReplacerPolicy(const std::string &name, ReplacerPolicy *policy) -> bool;
+
 }  // namespace bustub
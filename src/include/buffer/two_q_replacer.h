@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.h
+//
+// Identification: src/include/buffer/two_q_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full 2Q replacement policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A newly loaded page goes into A1in, a FIFO queue that further accesses do not reorder. When A1in holds more than
+ * Kin = c / 4 frames, its oldest frame is evicted and the page is remembered in the ghost queue A1out, which keeps the
+ * last Kout = c / 2 such pages. A page that is loaded again while it is in A1out has proven to be hot, and goes into
+ * Am, which is managed as LRU. Otherwise the victim is the LRU frame of Am. Pages that are only accessed once, as in a
+ * scan, thus never displace the pages in Am.
+ *
+ * The buffer pool has to tell the replacer which page a frame holds with SetPageId(), since frame ids are reused. The
+ * cache size c is the largest number of frames tracked at the same time, i.e. the pool size once the pool has filled
+ * up. Non-evictable frames stay in their queue, and Evict() skips them.
+ */
+class TwoQReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQReplacer.
+   * @param num_frames the maximum number of frames the TwoQReplacer will be required to store
+   */
+  explicit TwoQReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQReplacer);
+
+  ~TwoQReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+ private:
+  /** The queue a frame is in. */
+  enum class TwoQList { NONE, A1IN, AM };
+
+  /** What the replacer knows about a frame. */
+  struct FrameInfo {
+    TwoQList list_{TwoQList::NONE};
+    bool evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** Position of the frame in a1in_ or am_, if it is tracked. */
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** @brief Throw if frame_id is out of range. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** @brief Whether the next victim comes from A1in, given the size of A1in and the evictable frames in both queues. */
+  auto EvictFromA1in(size_t a1in_size, size_t a1in_evictable, size_t am_evictable) const -> bool;
+
+  /** @brief Stop tracking a frame. */
+  void Forget(frame_id_t frame_id);
+
+  auto Queue(TwoQList list) -> std::list<frame_id_t> & { return list == TwoQList::A1IN ? a1in_ : am_; }
+
+  size_t num_frames_;
+  /** c, the largest number of frames tracked so far. */
+  size_t capacity_{0};
+
+  std::mutex latch_;
+
+  /** Per frame, what the replacer knows about it. */
+  std::vector<FrameInfo> frames_;
+  /** The frames in A1in, most recently loaded first. */
+  std::list<frame_id_t> a1in_;
+  /** The frames in Am, most recently accessed first. */
+  std::list<frame_id_t> am_;
+  /** The number of evictable frames in a1in_ and in am_. */
+  size_t a1in_evictable_{0};
+  size_t am_evictable_{0};
+
+  /** The pages evicted from A1in, most recently evicted first. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+};
+
+}  // namespace bustub
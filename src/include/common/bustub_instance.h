@@ -34,6 +34,7 @@ class Transaction;
 class ExecutorContext;
 class DiskManager;
 class BufferPoolManager;
+class AccessTrace;
 class LockManager;
 class TransactionManager;
 class LogManager;
@@ -270,8 +271,14 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdDisplayBufferPoolStats(ResultWriter &writer);
+  void CmdBufferPoolTrace(const std::string &args, ResultWriter &writer);
+  void SetBufferPoolSize(const std::string &value);
+  void SetBufferPoolReplacer(const std::string &value);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
+  /** The trace of buffer pool accesses recorded by `\bptrace`. Kept until the buffer pool is gone. */
+  std::unique_ptr<AccessTrace> access_trace_;
 };
 
 }  // namespace bustub
@@ -27,15 +27,35 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** If the background flusher of a buffer pool is running, it looks for dirty victims every BACKGROUND_FLUSH_INTERVAL. */
+extern std::chrono::milliseconds background_flush_interval;
+
+/** True if buffer pool frames should come from explicit huge pages (MAP_HUGETLB), when the system has some reserved. */
+extern std::atomic<bool> buffer_pool_huge_pages;
+
+/** The NUMA node that buffer pool frames are bound to, or -1 to leave their placement to the kernel. */
+extern std::atomic<int> buffer_pool_numa_node;
+
+/** True if disk managers opened from now on should checksum the pages they write and verify the pages they read. */
+extern std::atomic<bool> enable_page_checksums;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
 static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
+static constexpr int BUFFER_POOL_INSTANCES = 4;  // number of buffer pool instances in a parallel BPM
+static constexpr int BUFFER_POOL_MAX_SIZE = 1 << 14;  // frames that `SET buffer_pool_size` can grow the shell's pool to
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int BUFFER_RING_SIZE = 32;  // max frames per buffer pool instance used by one bulk read, see BufferRing
+static constexpr int ACCESS_TRACE_CAPACITY = 1 << 20;  // number of page accesses an AccessTrace keeps by default
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;  // alignment of O_DIRECT buffers, offsets and sizes
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;  // max I/Os in flight in an AsyncDiskManager
+static constexpr int ASYNC_IO_THREADS = 4;  // I/O threads of an AsyncDiskManager that cannot use io_uring
+static constexpr int EXTENT_SIZE = 64;  // contiguous pages reserved at a time for a table heap or index
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -49,6 +49,10 @@ enum class ExceptionType {
   NOT_IMPLEMENTED = 11,
   /** Execution exception. */
   EXECUTION = 12,
+  /** Data on disk failed its checksum. */
+  DATA_CORRUPTION = 13,
+  /** Data could not be written to disk. */
+  IO_ERROR = 14,
 };
 
 class Exception : public std::runtime_error {
@@ -104,6 +108,10 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::DATA_CORRUPTION:
+        return "Data corruption";
+      case ExceptionType::IO_ERROR:
+        return "I/O error";
       default:
         return "Unknown";
     }
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>  // NOLINT
 #include <shared_mutex>
 
@@ -21,18 +23,31 @@ namespace bustub {
 
 /**
  * Reader-Writer latch backed by std::mutex.
+ *
+ * Besides shared and exclusive locking, the latch supports optimistic reads: a version counter that is odd while a
+ * writer holds the latch, and that every write lock advances. An optimistic reader records the version, reads without
+ * taking the latch, and afterwards checks that the version did not change. Optimistic readers write no shared memory,
+ * so they do not bounce the latch's cache line between cores.
  */
 class ReaderWriterLatch {
  public:
   /**
    * Acquire a write latch.
    */
-  void WLock() { mutex_.lock(); }
+  void WLock() {
+    mutex_.lock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    // Keep the writes of the critical section from becoming visible before the version turns odd.
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /**
    * Release a write latch.
    */
-  void WUnlock() { mutex_.unlock(); }
+  void WUnlock() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    mutex_.unlock();
+  }
 
   /**
    * Acquire a read latch.
@@ -44,8 +59,31 @@ class ReaderWriterLatch {
    */
   void RUnlock() { mutex_.unlock_shared(); }
 
+  /**
+   * Start an optimistic read.
+   * @param[out] version the version to pass to ValidateOptimisticRead()
+   * @return false if a writer holds the latch, in which case the reader should take the read latch instead
+   */
+  auto TryOptimisticRead(uint64_t *version) const -> bool {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /**
+   * Finish an optimistic read. What was read may only be used if this returns true.
+   * @param version the version returned by TryOptimisticRead()
+   * @return true if no writer held the latch since TryOptimisticRead()
+   */
+  auto ValidateOptimisticRead(uint64_t version) const -> bool {
+    // Keep the reads of the optimistic section from moving past the version check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
  private:
   std::shared_mutex mutex_;
+  /** Odd while a writer holds the latch, advanced by every write lock and unlock. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
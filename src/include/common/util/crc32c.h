@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes CRC-32C (Castagnoli) checksums, as used for the pages on disk.
+ *
+ * On x86-64 CPUs with SSE4.2, Compute() uses the crc32 instruction, on three interleaved streams of eight byte words.
+ * Elsewhere it falls back to a table-driven software implementation, which computes the same checksums.
+ */
+class Crc32c {
+ public:
+  /**
+   * @brief Compute the CRC-32C of a buffer.
+   * @param data the bytes to checksum
+   * @param length the number of bytes
+   * @param crc the CRC-32C of the bytes before data, to checksum a buffer in pieces, 0 to start a new checksum
+   * @return the CRC-32C of the bytes so far
+   */
+  static auto Compute(const char *data, size_t length, uint32_t crc = 0) -> uint32_t;
+
+  /** @brief Compute the CRC-32C of a buffer without the crc32 instruction, see Compute(). */
+  static auto ComputeSoftware(const char *data, size_t length, uint32_t crc = 0) -> uint32_t;
+
+  /** @return true if Compute() uses the SSE4.2 crc32 instruction */
+  static auto HasHardwareSupport() -> bool;
+};
+
+}  // namespace bustub
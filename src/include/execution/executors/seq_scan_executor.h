@@ -12,17 +12,23 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "buffer/buffer_ring.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * The pages of the table are fetched through a BufferRing, so that scanning a large table does not flush the rest of
+ * the buffer pool.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -50,5 +56,11 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  TableInfo *table_info_{nullptr};
+  /** The frames that the scan reads the table into */
+  BufferRing ring_;
+  /** The position of the scan, created by Init() */
+  std::unique_ptr<TableIterator> iterator_;
 };
 }  // namespace bustub
@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bustub {
+
+/**
+ * AsyncDiskManager is a DiskManager that keeps many page reads and writes in flight at once.
+ *
+ * ReadPageAsync() and WritePageAsync() submit the I/O and return a future that becomes ready once it completes. The
+ * I/O goes through an io_uring with ASYNC_IO_QUEUE_DEPTH entries, whose completions are reaped by a dedicated thread.
+ * A short read or write is resubmitted for the rest of the page, as DoPageIO() retries it. Where io_uring is not
+ * available (other platforms than Linux, old kernels, seccomp filters), a pool of ASYNC_IO_THREADS threads runs the I/O
+ * with pread() and pwrite() instead. The synchronous ReadPage() and WritePage() are DiskManager's.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param use_io_uring false to always use the thread pool, e.g. to compare it with io_uring
+   */
+  explicit AsyncDiskManager(const std::string &db_file, bool use_io_uring = true);
+
+  DISALLOW_COPY_AND_MOVE(AsyncDiskManager);
+
+  /**
+   * Waits for the I/O in flight to complete, and stops the I/O threads.
+   */
+  ~AsyncDiskManager() override;
+
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> override;
+
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> override;
+
+  /** @return true if the I/O goes through io_uring, false if it goes through the thread pool */
+  auto UsesIoUring() const -> bool { return ring_fd_ >= 0; }
+
+ private:
+  /** A submitted read or write, owned by the I/O path until it completes. */
+  struct IoRequest {
+    bool write_;
+    page_id_t page_id_;
+    char *page_data_;
+    /** The buffer handed to io_uring, which must stay valid until the I/O completes. */
+    struct iovec iov_;
+    std::promise<void> promise_;
+    /** With checksums, the copy of the page that is written instead of the caller's buffer, which may change. */
+    std::unique_ptr<PageBuffer> copy_;
+    /** The number of bytes transferred so far by the io_uring, which resubmits short transfers for the rest. */
+    size_t done_{0};
+  };
+
+  /** @brief Map an io_uring into memory. @return false if the kernel does not let us create one */
+  auto SetUpIoUring() -> bool;
+
+  /** @brief Unmap and close the io_uring. */
+  void TearDownIoUring();
+
+  /**
+   * @brief Hand a request to the io_uring or the thread pool. A request that can't be submitted is failed and freed.
+   */
+  void Submit(IoRequest *request);
+
+  /**
+   * @brief Queue an entry on the io_uring and submit it, waiting for a free slot if the queue is full.
+   * @param request the read or write to submit, or nullptr to submit a no-op that wakes up the completion thread
+   * @param resubmit true if the request holds its slot already, because it is resubmitted for the rest of a short
+   * transfer
+   * @throws Exception of type IO_ERROR if the entry could not be submitted, which is then taken off the queue again
+   */
+  void SubmitToIoUring(IoRequest *request, bool resubmit = false);
+
+  /** @brief Main loop of the thread that reaps io_uring completions. */
+  void ReapCompletions();
+
+  /** @brief Main loop of the threads of the thread pool. */
+  void RunIoThread();
+
+  /** @brief Finish a request with DiskManager::FinishPageIO(), make its future ready and free it. */
+  void Complete(IoRequest *request, ssize_t result);
+
+  /** The io_uring, or -1 if the thread pool is used. */
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned sq_entries_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  /** Protects the submission queue, in_flight_ and stop_. */
+  std::mutex submit_latch_;
+  /** Notified when an I/O completes, waited on with submit_latch_ by submitters that find the queue full. */
+  std::condition_variable slot_cv_;
+  /** The number of requests submitted to the io_uring that have not completed yet. */
+  size_t in_flight_{0};
+  std::thread completion_thread_;
+
+  /** The requests waiting for an I/O thread, when io_uring is not used. Protected by queue_latch_. */
+  std::deque<IoRequest *> queue_;
+  std::mutex queue_latch_;
+  /** Wakes up the I/O threads, waited on with queue_latch_. */
+  std::condition_variable queue_cv_;
+  std::vector<std::thread> io_threads_;
+
+  /** Set to stop the I/O threads once all the I/O is done. Protected by submit_latch_ or queue_latch_. */
+  bool stop_{false};
+};
+
+}  // namespace bustub
@@ -12,11 +12,17 @@
 
 #pragma once
 
+#include <sys/types.h>
+
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "common/config.h"
 
@@ -25,22 +31,54 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with pread() and pwrite() at their offset in the database file. There is no shared file
+ * cursor, so concurrent reads and writes of different pages go to the disk in parallel without taking a lock.
+ *
+ * In direct I/O mode, the database file is opened with O_DIRECT (on macOS, F_NOCACHE is set instead, and other
+ * platforms fall back to buffered I/O), so pages bypass the kernel page cache instead of being cached twice, once there
+ * and once in the buffer pool. The frames of the buffer pool are aligned as O_DIRECT requires; other buffers that are
+ * not aligned to DIRECT_IO_ALIGNMENT go through an aligned bounce buffer.
+ *
+ * With page checksums (enable_page_checksums), the CRC-32C of every page written is stored in a checksum file next to
+ * the database file, at offset 4 + page_id * 4, after the page itself is written. A page is copied before it is
+ * written, and the copy is written and checksummed, since the caller's buffer may change meanwhile. The checksum file
+ * is mapped into memory, so that stamping and looking up a checksum need no system call. ReadPage() verifies a page
+ * against its stored checksum, and throws an Exception of type DATA_CORRUPTION if they differ, e.g. because the page
+ * was torn by a crash of the process in the middle of a write. Neither file is synced, so the order of the two writes
+ * only holds up to the page cache: after a crash of the OS or a power failure, a page that reached the disk without its
+ * checksum, or the other way round, fails verification even though it is intact. Pages without a stored checksum (0),
+ * such as pages written before checksums were enabled, are not verified. A disk manager opened without checksums leaves
+ * the checksum file alone, but its first write marks the file's header stale, since the pages it writes no longer match
+ * their checksums. The next disk manager with checksums then treats every stored checksum as unknown (0). The checksums
+ * live outside the page, so every page layout keeps all of its bytes.
+ *
+ * Pages are allocated and deallocated through a free-page bitmap with one bit per page, persisted in a file next to the
+ * database file, so that the allocated page ids survive a restart. AllocatePage() hands out the lowest free page id, so
+ * deallocated pages are reused before the database file grows.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the page cache with O_DIRECT, if the file system supports it
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
+
+  /** The number of 4-byte words before the checksums in the checksum file, which hold whether they are stale */
+  static constexpr size_t CHECKSUM_HEADER_SIZE = 1;
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  /**
+   * Closes the database file if ShutDown() has not.
+   */
+  virtual ~DiskManager();
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager and close all the file resources. No page I/O may be in progress.
    */
   void ShutDown();
 
@@ -48,6 +86,7 @@ class DiskManager {
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
+   * @throws Exception of type IO_ERROR if the page could not be written
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
@@ -55,15 +94,62 @@ class DiskManager {
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @throws Exception of type DATA_CORRUPTION if the page does not match its checksum
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Allocate a page: the lowest free page id of the stripe offset, offset + stride, offset + 2 * stride, ...
+   * Stripes let the instances of a parallel buffer pool share a disk manager.
+   * @param stride the distance between the page ids of the stripe
+   * @param offset the first page id of the stripe, less than stride
+   * @return the id of the allocated page
+   */
+  auto AllocatePage(uint32_t stride = 1, uint32_t offset = 0) -> page_id_t;
+
+  /**
+   * Allocate an extent: num_pages pages with consecutive ids, which are contiguous in the database file. The first run
+   * of enough free pages is reused, otherwise the extent goes at the end of the file.
+   * @param num_pages number of pages in the extent
+   * @return the id of the first page of the extent
+   */
+  auto AllocateExtent(size_t num_pages) -> page_id_t;
+
+  /**
+   * Deallocate a page, so that AllocatePage() can hand it out again. On Linux, its space in the database file is
+   * returned to the file system by punching a hole, elsewhere it is zeroed. Either way, it reads as zeroes until it is
+   * written again. Pages that are not allocated are ignored.
+   * @param page_id id of the page
+   */
+  virtual void DeallocatePage(page_id_t page_id);
+
+  /** @return true if the page is allocated */
+  auto IsPageAllocated(page_id_t page_id) -> bool;
+
+  /**
+   * Start writing a page to the database file. The default implementation writes synchronously.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid until the returned future is ready
+   * @return a future that becomes ready once the write has completed, or holds the exception if it failed
+   */
+  virtual auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  /**
+   * Start reading a page from the database file. The default implementation reads synchronously.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the returned future is ready
+   * @return a future that becomes ready once the read has completed, and that holds the exception of a corrupt page
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
+  /**
+   * Append the entire log buffer to the log file, and make it durable with fdatasync(), or fsync() on other platforms
+   * than Linux. Calls must alternate between two log buffers, and must not overlap.
    * @param log_data raw log data
    * @param size size of log entry
+   * @return false if the log could not be written or synced, true once it is durable
    */
-  void WriteLog(char *log_data, int size);
+  auto WriteLog(char *log_data, int size) -> bool;
 
   /**
    * Read a log entry from the log file.
@@ -83,6 +169,15 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return true if the database file bypasses the page cache, with O_DIRECT or F_NOCACHE */
+  auto UsesDirectIO() const -> bool { return direct_io_; }
+
+  /** @return true if pages are checksummed on write and verified on read */
+  auto UsesChecksums() const -> bool { return checksum_fd_ >= 0; }
+
+  /** @return the number of pages read that did not match their checksum */
+  auto GetNumChecksumFailures() const -> int { return num_checksum_failures_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -93,19 +188,116 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
+  /** A page-sized buffer, aligned as O_DIRECT requires. */
+  struct alignas(DIRECT_IO_ALIGNMENT) PageBuffer {
+    char data_[BUSTUB_PAGE_SIZE];
+  };
+
   auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
-  std::fstream log_io_;
+
+  /**
+   * Read or write a whole page at its offset in the database file, retrying short transfers.
+   * @param write true to write the page, false to read it
+   * @param page_id id of the page
+   * @param page_data the page's buffer
+   * @return the number of bytes transferred, which is less than a page only for reads past the end of the file, or
+   * -errno on failure
+   */
+  auto DoPageIO(bool write, page_id_t page_id, char *page_data) -> ssize_t;
+
+  /**
+   * Finish the I/O of a page: log failures, zero the rest of a page that was read past the end of the file, and grow
+   * the cached file size after a write. With checksums, store the checksum of a written page, and verify a read page.
+   * @param write true if the page was written, false if it was read
+   * @param page_id id of the page
+   * @param page_data the page's buffer
+   * @param result the result of DoPageIO()
+   * @throws Exception of type DATA_CORRUPTION if the page read does not match its checksum
+   * @throws Exception of type IO_ERROR if the page could not be written
+   */
+  void FinishPageIO(bool write, page_id_t page_id, char *page_data, ssize_t result);
+
+  /**
+   * @return the checksum of a page as stored in the checksum file, never 0 so that 0 can mean "no checksum"
+   */
+  static auto PageChecksum(const char *page_data) -> uint32_t;
+
+  /**
+   * Grow the checksum file and its mapping to hold at least num_checksums checksums. Caller should hold
+   * checksums_latch_ exclusively.
+   * @return false if the checksum file could not be grown or mapped
+   */
+  auto MapChecksums(size_t num_checksums) -> bool;
+
+  /**
+   * Mark the checksums of the database file stale, once, before a disk manager without checksums first changes a page.
+   */
+  void MarkChecksumsStale();
+
+  /**
+   * Set or clear the bits of consecutive pages in the free-page bitmap, and persist them. Caller should hold
+   * allocation_latch_.
+   * @param first_page_id id of the first page
+   * @param num_pages number of pages
+   * @param allocated the new state of the pages
+   */
+  void SetPagesAllocated(page_id_t first_page_id, size_t num_pages, bool allocated);
+
+  /**
+   * Get the free pages split by stripe, building the split on the first call for a stride. Caller should hold
+   * allocation_latch_.
+   * @param stride the distance between the page ids of a stripe
+   * @return the free pages of each stripe, indexed by its offset
+   */
+  auto StripeFreePages(uint32_t stride) -> std::vector<std::set<page_id_t>> &;
+
+  /** Add a page to the free pages, and to its stripes. Caller should hold allocation_latch_. */
+  void InsertFreePage(page_id_t page_id);
+
+  /** Remove a page from the free pages, and from its stripes. Caller should hold allocation_latch_. */
+  void EraseFreePage(page_id_t page_id);
+
+  // file descriptor of the log file, -1 if it is not open
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // size of the log file in bytes, where the next WriteLog() appends
+  int64_t log_size_{0};
+  // file descriptor of the db file, -1 if it is not open
+  int db_fd_{-1};
   std::string file_name_;
+  // true if db_fd_ bypasses the page cache, with O_DIRECT or F_NOCACHE
+  bool direct_io_{false};
+  // file descriptor of the checksum file, -1 if pages are not checksummed
+  int checksum_fd_{-1};
+  // the checksum file mapped with MAP_SHARED, starting with its header
+  uint32_t *checksum_file_{nullptr};
+  // the checksums in the mapping after the header, indexed by page id, 0 where there is no checksum
+  uint32_t *checksums_{nullptr};
+  // the number of checksums that the mapping holds
+  size_t num_checksums_{0};
+  // true once the checksum file is known to be stale, or to need no marking because pages are checksummed
+  std::atomic<bool> checksums_stale_{true};
+  // taken exclusively to remap the checksum file, shared to access the mapping
+  std::shared_mutex checksums_latch_;
+  // file descriptor of the free-page bitmap file, -1 if allocations are only kept in memory
+  int fsm_fd_{-1};
+  // the free-page bitmap, with a set bit for every allocated page
+  std::vector<uint8_t> allocated_;
+  // the free page ids below end_page_id_
+  std::set<page_id_t> free_pages_;
+  // free_pages_ split by stripe for every stride that pages were allocated with, so that allocation is O(log n)
+  std::unordered_map<uint32_t, std::vector<std::set<page_id_t>>> stripe_free_pages_;
+  // one past the highest allocated page id
+  page_id_t end_page_id_{0};
+  // protects fsm_fd_'s contents, allocated_, free_pages_, stripe_free_pages_ and end_page_id_
+  std::mutex allocation_latch_;
+  std::atomic<int> num_checksum_failures_{0};
+  // size of the db file in bytes, kept up to date by our writes so that reads do not need to stat the file
+  std::atomic<int64_t> db_file_size_{0};
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
@@ -52,8 +52,16 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /**
+   * Deallocate a page, and zero it. Pages that are not allocated, or lie past the memory, are ignored.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id) override;
+
  private:
   char *memory_;
+  // the number of pages that memory_ holds
+  size_t num_pages_;
 };
 
 /**
@@ -106,6 +114,20 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
+  /**
+   * Deallocate a page, and release its memory.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id) override {
+    {
+      std::scoped_lock<std::mutex> l(mutex_);
+      if (page_id >= 0 && page_id < static_cast<int>(data_.size())) {
+        data_[page_id] = nullptr;
+      }
+    }
+    DiskManager::DeallocatePage(page_id);
+  }
+
  private:
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** How the pages of a DiskManagerMmap are going to be read, passed on to the kernel with madvise(). */
+enum class MmapAccessPattern { NORMAL, SEQUENTIAL, RANDOM };
+
+/**
+ * DiskManagerMmap serves the pages of a read-only database file, e.g. a snapshot on an analytic replica, straight from
+ * a shared memory mapping of the file. Like DiskManagerMemory, it keeps the pages in memory instead of reading them
+ * with system calls, but the memory is the kernel page cache: opening the file costs nothing up front, and processes
+ * that map the same file share its cached pages.
+ *
+ * ReadPage() copies a page out of the mapping. Readers that do not need a private copy can use GetPageData() instead,
+ * which points into the mapping. Writing a page throws.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Map a database file.
+   * @param db_file the file name of the database file to read
+   * @param access_pattern how the pages are going to be read
+   */
+  explicit DiskManagerMmap(const std::string &db_file, MmapAccessPattern access_pattern = MmapAccessPattern::NORMAL);
+
+  DISALLOW_COPY_AND_MOVE(DiskManagerMmap);
+
+  /**
+   * Unmaps the database file.
+   */
+  ~DiskManagerMmap() override;
+
+  /**
+   * The database file is read-only, this always throws.
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Copy a page out of the mapping. Pages past the end of the file read as zeroes.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Get a page without copying it. The first access to a page that is not in the page cache yet blocks until the kernel
+   * has read it in.
+   * @param page_id id of the page
+   * @return the page's data in the mapping, valid as long as the disk manager, or nullptr past the end of the file
+   */
+  auto GetPageData(page_id_t page_id) const -> const char *;
+
+  /** @return the number of pages in the database file */
+  auto GetNumPages() const -> size_t { return size_ / BUSTUB_PAGE_SIZE; }
+
+  /**
+   * Tell the kernel how the pages are going to be read from now on, e.g. sequentially for a scan. Only a hint.
+   * @param access_pattern how the pages are going to be read
+   */
+  void SetAccessPattern(MmapAccessPattern access_pattern);
+
+  /**
+   * Ask the kernel to start reading a range of pages into the page cache in the background. Only a hint.
+   * @param first_page_id the first page of the range
+   * @param num_pages the number of pages in the range
+   */
+  void WillNeed(page_id_t first_page_id, size_t num_pages);
+
+ private:
+  /** The mapping of the database file, nullptr if the file is empty. */
+  char *data_{nullptr};
+  /** The size of the mapping, the number of whole pages in the file times BUSTUB_PAGE_SIZE. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
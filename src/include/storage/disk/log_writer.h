@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_writer.h
+//
+// Identification: src/include/storage/disk/log_writer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * LogWriter appends log records to the log file of a DiskManager, and makes them durable with group commit.
+ *
+ * Append() copies a record into the active log buffer and gives it the next LSN. A dedicated thread writes the buffer
+ * out with DiskManager::WriteLog(), i.e. one pwrite() and one fdatasync(), while new records go into the other buffer.
+ * Every transaction that commits while a sync is in progress shares the next sync, so the number of syncs is bounded by
+ * the sync latency rather than by the number of commits, and commit throughput grows with the number of concurrent
+ * committers. Records that nobody waits for are written out once the buffer is half full, or after log_timeout.
+ *
+ * LSNs number the records appended through this writer, starting at 0.
+ */
+class LogWriter {
+ public:
+  /**
+   * @brief Start the log writer thread.
+   * @param disk_manager the disk manager whose log file the records are appended to
+   * @param buffer_size the size of each of the two log buffers, which bounds the size of a record
+   */
+  explicit LogWriter(DiskManager *disk_manager, size_t buffer_size = LOG_BUFFER_SIZE);
+
+  DISALLOW_COPY_AND_MOVE(LogWriter);
+
+  /**
+   * @brief Write out the records that are left, and stop the log writer thread.
+   */
+  ~LogWriter();
+
+  /**
+   * @brief Append a record to the log, without waiting for it to become durable. Waits if both buffers are full.
+   * @param record the record's bytes
+   * @param size the record's size, at most the buffer size
+   * @return the record's LSN
+   */
+  auto Append(const char *record, size_t size) -> lsn_t;
+
+  /**
+   * @brief Wait until a record is durable. Throws if the log could not be written.
+   * @param lsn the record's LSN
+   * @return the durable LSN, which is lsn or later
+   */
+  auto WaitDurable(lsn_t lsn) -> lsn_t;
+
+  /**
+   * @brief Append a commit record and wait until it is durable.
+   * @param record the record's bytes
+   * @param size the record's size, at most the buffer size
+   * @return the durable LSN, which is the record's LSN or later
+   */
+  auto Commit(const char *record, size_t size) -> lsn_t { return WaitDurable(Append(record, size)); }
+
+  /** @return the LSN up to which all records are durable, INVALID_LSN if none are */
+  auto GetDurableLSN() -> lsn_t;
+
+  /** @return the number of log writes, each of which is synced once */
+  auto GetNumSyncs() -> size_t;
+
+ private:
+  /** @brief Main loop of the log writer thread. */
+  void RunWriter();
+
+  DiskManager *disk_manager_;
+  const size_t buffer_size_;
+  /** The buffer that records are appended to. Protected by latch_. */
+  char *log_buffer_;
+  /** The buffer that the log writer thread writes out. */
+  char *flush_buffer_;
+  /** The bytes used in log_buffer_. Protected by latch_. */
+  size_t log_buffer_used_{0};
+  /** The LSN of the next record. Protected by latch_. */
+  lsn_t next_lsn_{0};
+  /** The LSN up to which all records are durable. Protected by latch_. */
+  lsn_t durable_lsn_{INVALID_LSN};
+  /** The number of threads in WaitDurable(). Protected by latch_. */
+  size_t num_waiters_{0};
+  /** The number of log writes. Protected by latch_. */
+  size_t num_syncs_{0};
+  /** Set once a log write failed, after which no record becomes durable anymore. Protected by latch_. */
+  bool failed_{false};
+  /** Set to stop the log writer thread once the log buffer is written out. Protected by latch_. */
+  bool stop_{false};
+  std::mutex latch_;
+  /** Wakes up the log writer thread, waited on with latch_. */
+  std::condition_variable writer_cv_;
+  /** Notified when the buffers are swapped and when the durable LSN advances, waited on with latch_. */
+  std::condition_variable durable_cv_;
+  std::thread writer_thread_;
+};
+
+}  // namespace bustub
@@ -75,8 +75,12 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
 
-  // given any key, we can find a leaf page that may hold the key
-  auto FindLeaf(const KeyType &key, Transaction *transaction = nullptr) -> Page*;
+  // given any key, we can find a leaf page that may hold the key. the returned guard holds its pin, but no latch.
+  auto FindLeaf(const KeyType &key, Transaction *transaction = nullptr) -> BasicPageGuard;
+
+  // if "page" is an internal page, set "child_page_id" to the child that may hold the key and return true.
+  // the page is read optimistically, and only read latched when a writer gets in the way.
+  auto FindChildOptimistic(Page *page, const KeyType &key, page_id_t *child_page_id) -> bool;
 
   // Insert a new k/v pair into the parent. Parent might be split as well.
   void InsertIntoParent(BPlusTreePage *new_node);
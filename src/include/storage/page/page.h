@@ -14,6 +14,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
@@ -30,8 +31,14 @@ class Page {
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates zeroed page data owned by this page. */
+  Page() : owned_data_(new char[BUSTUB_PAGE_SIZE]{}), data_(owned_data_.get()) {}
+
+  /**
+   * Constructor for the frames of a buffer pool, whose data lives in the buffer pool's FrameArena.
+   * @param data BUSTUB_PAGE_SIZE bytes of zeroed memory that outlive this page
+   */
+  explicit Page(char *data) : data_(data) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -60,6 +67,22 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read of the page, which takes no latch. The reader may see the page in the middle of a write,
+   * so it must not act on what it read until ValidateOptimisticRLatch() succeeds, and must not follow anything it read
+   * out of the bounds of the page.
+   * @param[out] version the version to validate against
+   * @return false if the page is write latched right now, in which case the reader should take the read latch instead
+   */
+  inline auto TryOptimisticRLatch(uint64_t *version) -> bool { return rwlatch_.TryOptimisticRead(version); }
+
+  /**
+   * Finish an optimistic read of the page.
+   * @param version the version returned by TryOptimisticRLatch()
+   * @return true if the page was not write latched in the meantime, i.e. what was read is consistent
+   */
+  inline auto ValidateOptimisticRLatch(uint64_t version) -> bool { return rwlatch_.ValidateOptimisticRead(version); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,8 +101,10 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
 
+  /** The data of a page that was not given any memory, nullptr for the frames of a buffer pool. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
+  char *data_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
@@ -0,0 +1,231 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard holds the pin on a page, and unpins it when it goes out of scope.
+ *
+ * Guards are move-only: moving a guard transfers the pin, and assigning to a guard first drops the pin it held.
+ * A guard can be dropped early with Drop(), after which it is empty. A BasicPageGuard takes no latch, so only use it
+ * for pages that are latched some other way, or upgrade it to a ReadPageGuard or a WritePageGuard.
+ */
+class BasicPageGuard {
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+ public:
+  /** Create an empty guard. */
+  BasicPageGuard() = default;
+
+  /**
+   * @brief Create a guard for a page that was pinned by FetchPage() or NewPage().
+   * @param bpm the buffer pool manager the page was pinned in
+   * @param page the pinned page, or nullptr for an empty guard
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  auto operator=(const BasicPageGuard &) -> BasicPageGuard & = delete;
+
+  /** @brief Take over the pin of another guard, which is left empty. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** @brief Drop the pin this guard holds, then take over the pin of another guard, which is left empty. */
+  auto operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard &;
+
+  /** @brief Unpin the page, if the guard still holds it. */
+  ~BasicPageGuard();
+
+  /** @brief Unpin the page, marking it dirty if it was modified through this guard. The guard is empty afterwards. */
+  void Drop();
+
+  /**
+   * @brief Read latch the page and move the pin into a ReadPageGuard. This guard is empty afterwards.
+   * @return the read guard, which is empty if this guard was
+   */
+  auto UpgradeRead() -> ReadPageGuard;
+
+  /**
+   * @brief Write latch the page and move the pin into a WritePageGuard. This guard is empty afterwards.
+   * @return the write guard, which is empty if this guard was
+   */
+  auto UpgradeWrite() -> WritePageGuard;
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return page_ != nullptr; }
+
+  /** @return the id of the guarded page, or INVALID_PAGE_ID for an empty guard */
+  auto PageId() const -> page_id_t { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+  /** @return the guarded page, for page types that subclass Page. Call SetDirty() after changing it. */
+  auto GetPage() -> Page * { return page_; }
+
+  /** @return the data of the guarded page, for reading */
+  auto GetData() -> const char * { return page_->GetData(); }
+
+  /** @return the data of the guarded page, which is marked dirty */
+  auto GetDataMut() -> char * {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the data of the guarded page as a T, for reading */
+  template <class T>
+  auto As() -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the data of the guarded page as a T, which is marked dirty */
+  template <class T>
+  auto AsMut() -> T * {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+  /** @brief Mark the guarded page dirty, so that it is unpinned as dirty. */
+  void SetDirty() { is_dirty_ = true; }
+
+ private:
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds the pin and the read latch on a page, and releases both when it goes out of scope.
+ */
+class ReadPageGuard {
+  friend class BasicPageGuard;
+
+ public:
+  /** Create an empty guard. */
+  ReadPageGuard() = default;
+
+  /**
+   * @brief Create a guard for a page that is pinned and read latched.
+   * @param bpm the buffer pool manager the page was pinned in
+   * @param page the pinned and read latched page, or nullptr for an empty guard
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  auto operator=(const ReadPageGuard &) -> ReadPageGuard & = delete;
+
+  /** @brief Take over the pin and latch of another guard, which is left empty. */
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  /** @brief Release the pin and latch this guard holds, then take over those of another guard. */
+  auto operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard &;
+
+  /** @brief Release the latch and the pin, if the guard still holds them. */
+  ~ReadPageGuard();
+
+  /** @brief Release the latch, then unpin the page. The guard is empty afterwards. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page, or INVALID_PAGE_ID for an empty guard */
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  /** @return the guarded page, for page types that subclass Page */
+  auto GetPage() -> const Page * { return guard_.GetPage(); }
+
+  /** @return the data of the guarded page */
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  /** @return the data of the guarded page as a T */
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds the pin and the write latch on a page, and releases both when it goes out of scope.
+ */
+class WritePageGuard {
+  friend class BasicPageGuard;
+
+ public:
+  /** Create an empty guard. */
+  WritePageGuard() = default;
+
+  /**
+   * @brief Create a guard for a page that is pinned and write latched.
+   * @param bpm the buffer pool manager the page was pinned in
+   * @param page the pinned and write latched page, or nullptr for an empty guard
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  auto operator=(const WritePageGuard &) -> WritePageGuard & = delete;
+
+  /** @brief Take over the pin and latch of another guard, which is left empty. */
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  /** @brief Release the pin and latch this guard holds, then take over those of another guard. */
+  auto operator=(WritePageGuard &&that) noexcept -> WritePageGuard &;
+
+  /** @brief Release the latch and the pin, if the guard still holds them. */
+  ~WritePageGuard();
+
+  /** @brief Release the latch, then unpin the page, marking it dirty if it was modified. The guard is empty after. */
+  void Drop();
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  /** @return the id of the guarded page, or INVALID_PAGE_ID for an empty guard */
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  /** @return the guarded page, for page types that subclass Page. Call SetDirty() after changing it. */
+  auto GetPage() -> Page * { return guard_.GetPage(); }
+
+  /** @return the data of the guarded page, for reading */
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  /** @return the data of the guarded page, which is marked dirty */
+  auto GetDataMut() -> char * { return guard_.GetDataMut(); }
+
+  /** @return the data of the guarded page as a T, for reading */
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+  /** @return the data of the guarded page as a T, which is marked dirty */
+  template <class T>
+  auto AsMut() -> T * {
+    return guard_.AsMut<T>();
+  }
+
+  /** @brief Mark the guarded page dirty, so that it is unpinned as dirty. */
+  void SetDirty() { guard_.SetDirty(); }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
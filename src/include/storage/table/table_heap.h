@@ -12,7 +12,10 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/extent_allocator.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
@@ -22,7 +25,8 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. New pages are created in extents of contiguous pages, so that the list
+ * mostly runs forward through the file and a sequential scan reads it sequentially.
  */
 class TableHeap {
   friend class TableIterator;
@@ -99,8 +103,12 @@ class TableHeap {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
 
-  /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  /**
+   * @param txn transaction performing the scan
+   * @param ring the ring to fetch the pages of a large scan through, nullptr to fetch them into the whole buffer pool
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn, BufferRing *ring = nullptr) -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
@@ -113,6 +121,7 @@ class TableHeap {
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  ExtentAllocator extent_allocator_;
 };
 
 }  // namespace bustub
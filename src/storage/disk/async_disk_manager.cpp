@@ -0,0 +1,318 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, bool use_io_uring) : DiskManager(db_file) {
+  if (use_io_uring && SetUpIoUring()) {
+    completion_thread_ = std::thread(&AsyncDiskManager::ReapCompletions, this);
+    return;
+  }
+  io_threads_.reserve(ASYNC_IO_THREADS);
+  for (int i = 0; i < ASYNC_IO_THREADS; i++) {
+    io_threads_.emplace_back(&AsyncDiskManager::RunIoThread, this);
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() {
+  if (UsesIoUring()) {
+    {
+      std::scoped_lock lock(submit_latch_);
+      stop_ = true;
+    }
+    // Wake up the completion thread, which leaves once everything in flight has completed.
+    SubmitToIoUring(nullptr);
+    completion_thread_.join();
+    TearDownIoUring();
+  } else {
+    {
+      std::scoped_lock lock(queue_latch_);
+      stop_ = true;
+    }
+    queue_cv_.notify_all();
+    for (auto &thread : io_threads_) {
+      thread.join();
+    }
+  }
+}
+
+auto AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  num_writes_ += 1;
+  MarkChecksumsStale();
+  auto *request = new IoRequest{true, page_id, const_cast<char *>(page_data), {}, {}, {}};
+  if (UsesChecksums()) {
+    // The page may change while it is written, so write a copy, which the checksum covers exactly.
+    request->copy_ = std::make_unique<PageBuffer>();
+    memcpy(request->copy_->data_, page_data, BUSTUB_PAGE_SIZE);
+    request->page_data_ = request->copy_->data_;
+  }
+  auto future = request->promise_.get_future();
+  Submit(request);
+  return future;
+}
+
+auto AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  auto *request = new IoRequest{false, page_id, page_data, {}, {}, {}};
+  auto future = request->promise_.get_future();
+  Submit(request);
+  return future;
+}
+
+void AsyncDiskManager::Submit(IoRequest *request) {
+  if (UsesIoUring()) {
+    try {
+      SubmitToIoUring(request);
+    } catch (const Exception &) {
+      // The request never reached the kernel, so no completion will free it.
+      request->promise_.set_exception(std::current_exception());
+      delete request;
+    }
+    return;
+  }
+  {
+    std::scoped_lock lock(queue_latch_);
+    queue_.push_back(request);
+  }
+  queue_cv_.notify_one();
+}
+
+#if defined(__linux__)
+
+auto AsyncDiskManager::SetUpIoUring() -> bool {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, ASYNC_IO_QUEUE_DEPTH, &params));
+  if (ring_fd_ < 0) {
+    LOG_DEBUG("io_uring is not available, falling back to an I/O thread pool");
+    ring_fd_ = -1;
+    return false;
+  }
+
+  // The submission and completion rings share one mapping if the kernel supports it.
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_
+                         : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                                IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+    LOG_DEBUG("can't map the io_uring, falling back to an I/O thread pool");
+    sqes_ = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe *>(sqes);
+    TearDownIoUring();
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_entries_ = params.sq_entries;
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  return true;
+}
+
+void AsyncDiskManager::TearDownIoUring() {
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != MAP_FAILED && cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != MAP_FAILED && sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  sqes_ = nullptr;
+  cq_ring_ = sq_ring_ = nullptr;
+  close(ring_fd_);
+  ring_fd_ = -1;
+}
+
+void AsyncDiskManager::SubmitToIoUring(IoRequest *request, bool resubmit) {
+  std::unique_lock lock(submit_latch_);
+  // The completion queue has room for twice as many entries, so it cannot overflow while in_flight_ stays below this.
+  if (request != nullptr && !resubmit) {
+    slot_cv_.wait(lock, [&] { return in_flight_ < sq_entries_; });
+    in_flight_++;
+  }
+
+  // Without SQPOLL, the kernel consumes the entry during io_uring_enter(), so the slot is free again right after.
+  const unsigned tail = *sq_tail_;
+  const unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_NOP;
+  sqe->fd = db_fd_;
+  if (request != nullptr) {
+    // Only the rest of the page after a short transfer.
+    request->iov_.iov_base = request->page_data_ + request->done_;
+    request->iov_.iov_len = BUSTUB_PAGE_SIZE - request->done_;
+    sqe->opcode = request->write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(request->page_id_) * BUSTUB_PAGE_SIZE + request->done_;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+  while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+      continue;
+    }
+    const int error = errno;
+    if (__atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) != tail) {
+      // The kernel took the entry after all, its completion finishes the request.
+      return;
+    }
+    // Take the entry off the queue again, so that a later submission does not pick it up.
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    if (request != nullptr && !resubmit) {
+      in_flight_--;
+      lock.unlock();
+      slot_cv_.notify_all();
+    }
+    throw Exception(ExceptionType::IO_ERROR, fmt::format("can't submit I/O to the io_uring: {}", strerror(error)));
+  }
+}
+
+void AsyncDiskManager::ReapCompletions() {
+  while (true) {
+    {
+      std::scoped_lock lock(submit_latch_);
+      if (stop_ && in_flight_ == 0) {
+        return;
+      }
+    }
+    if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+      LOG_DEBUG("can't wait for io_uring completions");
+    }
+
+    // The kernel only writes the tail and we are the only reader of the head.
+    unsigned head = *cq_head_;
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    size_t completed = 0;
+    std::vector<IoRequest *> short_transfers;
+    for (; head != tail; head++) {
+      const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+      auto *request = reinterpret_cast<IoRequest *>(cqe.user_data);
+      // The NOP that wakes us up for shutting down has no request.
+      if (request == nullptr) {
+        continue;
+      }
+      if (cqe.res == -EINTR || cqe.res == -EAGAIN ||
+          (cqe.res > 0 && request->done_ + cqe.res < static_cast<size_t>(BUSTUB_PAGE_SIZE))) {
+        // Transfer the rest, like DoPageIO() does. The request keeps its slot.
+        request->done_ += std::max(cqe.res, 0);
+        short_transfers.push_back(request);
+        continue;
+      }
+      // A read of 0 bytes is the end of the file, which FinishPageIO() zeroes the rest of the page for.
+      Complete(request, cqe.res < 0 ? cqe.res : static_cast<ssize_t>(request->done_ + cqe.res));
+      completed++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+    for (auto *request : short_transfers) {
+      try {
+        SubmitToIoUring(request, true);
+      } catch (const Exception &) {
+        request->promise_.set_exception(std::current_exception());
+        delete request;
+        completed++;
+      }
+    }
+
+    if (completed > 0) {
+      {
+        std::scoped_lock lock(submit_latch_);
+        in_flight_ -= completed;
+      }
+      slot_cv_.notify_all();
+    }
+  }
+}
+
+#else
+
+// Without io_uring, every AsyncDiskManager uses the thread pool.
+auto AsyncDiskManager::SetUpIoUring() -> bool { return false; }
+
+void AsyncDiskManager::TearDownIoUring() {}
+
+void AsyncDiskManager::SubmitToIoUring(IoRequest *request, bool resubmit) {
+  UNREACHABLE("io_uring is only available on Linux");
+}
+
+void AsyncDiskManager::ReapCompletions() { UNREACHABLE("io_uring is only available on Linux"); }
+
+#endif
+
+void AsyncDiskManager::RunIoThread() {
+  std::unique_lock lock(queue_latch_);
+  while (true) {
+    queue_cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+    // The queue is drained before stopping, so that every future becomes ready.
+    if (queue_.empty()) {
+      return;
+    }
+    IoRequest *request = queue_.front();
+    queue_.pop_front();
+
+    lock.unlock();
+    Complete(request, DoPageIO(request->write_, request->page_id_, request->page_data_));
+    lock.lock();
+  }
+}
+
+void AsyncDiskManager::Complete(IoRequest *request, ssize_t result) {
+  try {
+    FinishPageIO(request->write_, request->page_id_, request->page_data_, result);
+    request->promise_.set_value();
+  } catch (const Exception &) {
+    // A corrupt page, rethrown by the future's get().
+    request->promise_.set_exception(std::current_exception());
+  }
+  delete request;
+}
+
+}  // namespace bustub
@@ -10,8 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
@@ -20,6 +25,9 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "common/util/crc32c.h"
+#include "fmt/format.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -30,7 +38,7 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -38,101 +46,326 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
+  }
+  struct stat log_stat_buf;
+  if (fstat(log_fd_, &log_stat_buf) == 0) {
+    log_size_ = log_stat_buf.st_size;
+  }
+
+  if (direct_io) {
+#if defined(__linux__)
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    // Some file systems (tmpfs) refuse O_DIRECT, they fall back to buffered I/O.
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("%s does not support O_DIRECT, falling back to buffered I/O", db_file.c_str());
     }
+    direct_io_ = db_fd_ >= 0;
+#elif defined(__APPLE__)
+    // macOS has no O_DIRECT, F_NOCACHE keeps the pages of an open file out of the page cache instead.
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+    direct_io_ = db_fd_ >= 0 && fcntl(db_fd_, F_NOCACHE, 1) == 0;
+    if (db_fd_ >= 0 && !direct_io_) {
+      LOG_WARN("%s does not support F_NOCACHE, falling back to buffered I/O", db_file.c_str());
+    }
+#else
+    LOG_WARN("direct I/O is not supported on this platform, falling back to buffered I/O");
+#endif
+  }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) == 0) {
+    db_file_size_ = stat_buf.st_size;
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  const std::string checksum_name = file_name_.substr(0, n) + ".crc";
+  if (enable_page_checksums) {
+    checksum_fd_ = open(checksum_name.c_str(), O_RDWR | O_CREAT, 0644);
+    if (checksum_fd_ < 0) {
+      throw Exception("can't open checksum file");
+    }
+    // The checksums of a database file that was deleted would not match the pages of its replacement.
+    if (db_file_size_ == 0 && ftruncate(checksum_fd_, 0) != 0) {
+      LOG_DEBUG("can't truncate the checksum file: %s", strerror(errno));
+    }
+    struct stat checksum_stat_buf;
+    if (fstat(checksum_fd_, &checksum_stat_buf) == 0 &&
+        static_cast<size_t>(checksum_stat_buf.st_size) > CHECKSUM_HEADER_SIZE * sizeof(uint32_t)) {
+      if (!MapChecksums(checksum_stat_buf.st_size / sizeof(uint32_t) - CHECKSUM_HEADER_SIZE)) {
+        throw Exception("can't map checksum file");
+      }
+      // A disk manager without checksums wrote pages since, and we can't tell which.
+      if (checksum_file_[0] != 0) {
+        LOG_WARN("the checksums of %s are stale, its pages are not verified until they are written again",
+                 file_name_.c_str());
+        memset(checksums_, 0, num_checksums_ * sizeof(uint32_t));
+        checksum_file_[0] = 0;
+      }
+    }
+  } else {
+    // The checksum file is marked stale by the first write.
+    checksums_stale_ = false;
+  }
+
+  const std::string fsm_name = file_name_.substr(0, n) + ".fsm";
+  fsm_fd_ = open(fsm_name.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fsm_fd_ < 0) {
+    throw Exception("can't open free-page bitmap file");
+  }
+  if (db_file_size_ == 0 && ftruncate(fsm_fd_, 0) != 0) {
+    LOG_DEBUG("can't truncate the free-page bitmap file: %s", strerror(errno));
+  }
+  struct stat fsm_stat_buf;
+  if (fstat(fsm_fd_, &fsm_stat_buf) != 0) {
+    throw Exception("can't stat free-page bitmap file");
+  }
+  if (fsm_stat_buf.st_size == 0 && db_file_size_ > 0) {
+    // A database file from before the bitmap existed: every page in it is allocated.
+    const auto num_pages = static_cast<size_t>((db_file_size_ + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE);
+    allocated_.resize((num_pages + 7) / 8, 0xff);
+    if (num_pages % 8 != 0) {
+      allocated_.back() = static_cast<uint8_t>((1U << (num_pages % 8)) - 1);
+    }
+    if (pwrite(fsm_fd_, allocated_.data(), allocated_.size(), 0) != static_cast<ssize_t>(allocated_.size())) {
+      throw Exception("can't write free-page bitmap file");
+    }
+  } else {
+    allocated_.resize(fsm_stat_buf.st_size);
+    if (pread(fsm_fd_, allocated_.data(), allocated_.size(), 0) != static_cast<ssize_t>(allocated_.size())) {
+      throw Exception("can't read free-page bitmap file");
+    }
+  }
+  for (page_id_t page_id = 0; static_cast<size_t>(page_id) < allocated_.size() * 8; page_id++) {
+    if ((allocated_[page_id / 8] & (1U << (page_id % 8))) != 0) {
+      end_page_id_ = page_id + 1;
+    }
+  }
+  for (page_id_t page_id = 0; page_id < end_page_id_; page_id++) {
+    if ((allocated_[page_id / 8] & (1U << (page_id % 8))) == 0) {
+      free_pages_.insert(page_id);
     }
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  if (checksum_file_ != nullptr) {
+    munmap(checksum_file_, (CHECKSUM_HEADER_SIZE + num_checksums_) * sizeof(uint32_t));
+  }
+  if (checksum_fd_ >= 0) {
+    close(checksum_fd_);
+  }
+  if (fsm_fd_ >= 0) {
+    close(fsm_fd_);
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  if (checksum_file_ != nullptr) {
+    munmap(checksum_file_, (CHECKSUM_HEADER_SIZE + num_checksums_) * sizeof(uint32_t));
+    checksum_file_ = nullptr;
+    checksums_ = nullptr;
+    num_checksums_ = 0;
+  }
+  if (checksum_fd_ >= 0) {
+    close(checksum_fd_);
+    checksum_fd_ = -1;
+  }
+  if (fsm_fd_ >= 0) {
+    close(fsm_fd_);
+    fsm_fd_ = -1;
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+}
+
+auto DiskManager::AllocatePage(uint32_t stride, uint32_t offset) -> page_id_t {
+  BUSTUB_ASSERT(offset < stride, "The offset of a stripe must be less than its stride");
+  std::scoped_lock lock(allocation_latch_);
+  page_id_t page_id = INVALID_PAGE_ID;
+  const std::set<page_id_t> &free_pages = stride == 1 ? free_pages_ : StripeFreePages(stride)[offset];
+  if (!free_pages.empty()) {
+    page_id = *free_pages.begin();
+    EraseFreePage(page_id);
+  } else {
+    // Grow to the next page of the stripe. The pages skipped on the way belong to other stripes and stay free for them.
+    page_id = end_page_id_ + static_cast<page_id_t>((offset + stride - static_cast<uint32_t>(end_page_id_) % stride) %
+                                                    stride);
+    for (page_id_t skipped = end_page_id_; skipped < page_id; skipped++) {
+      InsertFreePage(skipped);
+    }
+    end_page_id_ = page_id + 1;
+  }
+  SetPagesAllocated(page_id, 1, true);
+  return page_id;
+}
+
+auto DiskManager::AllocateExtent(size_t num_pages) -> page_id_t {
+  BUSTUB_ASSERT(num_pages > 0, "An extent needs at least one page");
+  std::scoped_lock lock(allocation_latch_);
+  // The first run of free pages that is long enough, else the end of the file.
+  page_id_t run_start = INVALID_PAGE_ID;
+  size_t run_length = 0;
+  for (auto page_id : free_pages_) {
+    if (run_length > 0 && page_id == run_start + static_cast<page_id_t>(run_length)) {
+      run_length++;
+    } else {
+      run_start = page_id;
+      run_length = 1;
+    }
+    if (run_length == num_pages) {
+      break;
+    }
+  }
+  if (run_length == num_pages) {
+    for (page_id_t page_id = run_start; page_id < run_start + static_cast<page_id_t>(num_pages); page_id++) {
+      EraseFreePage(page_id);
+    }
+  } else {
+    run_start = end_page_id_;
+    end_page_id_ += static_cast<page_id_t>(num_pages);
+  }
+  SetPagesAllocated(run_start, num_pages, true);
+  return run_start;
+}
+
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  BUSTUB_ASSERT(page_id >= 0, "Cannot deallocate an invalid page id");
+  if (!IsPageAllocated(page_id)) {
+    return;
+  }
+  // Drop the contents before the page can be allocated again, so that they cannot overwrite those of its next owner.
+  // The page stays allocated meanwhile, and allocation_latch_ is not held, so that allocations don't wait for the I/O.
+  MarkChecksumsStale();
+  if (checksum_fd_ >= 0) {
+    std::shared_lock checksums_lock(checksums_latch_);
+    if (static_cast<size_t>(page_id) < num_checksums_) {
+      checksums_[page_id] = 0;
+    }
+  }
+  const off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (db_fd_ >= 0 && offset < db_file_size_.load()) {
+#if defined(__linux__)
+    const bool punched = fallocate(db_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, BUSTUB_PAGE_SIZE) == 0;
+#else
+    // Punching holes is Linux only.
+    const bool punched = false;
+#endif
+    if (!punched) {
+      // The file system cannot punch holes, so the page keeps its space but is zeroed.
+      static char zeroes[BUSTUB_PAGE_SIZE] = {};
+      if (DoPageIO(true, page_id, zeroes) != BUSTUB_PAGE_SIZE) {
+        LOG_DEBUG("can't zero deallocated page %d: %s", page_id, strerror(errno));
+      }
+    }
+  }
+  std::scoped_lock lock(allocation_latch_);
+  // A concurrent deallocation of the page may have freed it already.
+  if ((allocated_[page_id / 8] & (1U << (page_id % 8))) == 0) {
+    return;
+  }
+  SetPagesAllocated(page_id, 1, false);
+  InsertFreePage(page_id);
+  // Free pages at the end are not tracked, the next allocation past the end picks them up again.
+  while (!free_pages_.empty() && *free_pages_.rbegin() == end_page_id_ - 1) {
+    EraseFreePage(end_page_id_ - 1);
+    end_page_id_--;
   }
-  log_io_.close();
+}
+
+auto DiskManager::IsPageAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock lock(allocation_latch_);
+  return page_id >= 0 && static_cast<size_t>(page_id) < allocated_.size() * 8 &&
+         (allocated_[page_id / 8] & (1U << (page_id % 8))) != 0;
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  MarkChecksumsStale();
+  // pwrite() hands the data to the OS right away, there is no stream buffer to flush.
+  auto *data = const_cast<char *>(page_data);
+  if (checksum_fd_ >= 0) {
+    // Frames are flushed without their page latch, so the page may change while it is written. Write a copy, which the
+    // checksum covers exactly.
+    static thread_local PageBuffer copy;
+    memcpy(copy.data_, page_data, BUSTUB_PAGE_SIZE);
+    data = copy.data_;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  FinishPageIO(true, page_id, data, DoPageIO(true, page_id, data));
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
+  const int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset >= db_file_size_.load(std::memory_order_acquire)) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
-    }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
-    }
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  FinishPageIO(false, page_id, page_data, DoPageIO(false, page_id, page_data));
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  std::promise<void> promise;
+  try {
+    WritePage(page_id, page_data);
+    promise.set_value();
+  } catch (const Exception &e) {
+    promise.set_exception(std::current_exception());
   }
+  return promise.get_future();
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  std::promise<void> promise;
+  try {
+    ReadPage(page_id, page_data);
+    promise.set_value();
+  } catch (const Exception &e) {
+    promise.set_exception(std::current_exception());
+  }
+  return promise.get_future();
 }
 
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
  */
-void DiskManager::WriteLog(char *log_data, int size) {
+auto DiskManager::WriteLog(char *log_data, int size) -> bool {
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
 
   if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
-    return;
+    return true;
   }
 
   flush_log_ = true;
@@ -143,17 +376,35 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  // sequence write at the end of the log
+  int done = 0;
+  while (done < size) {
+    const ssize_t n = pwrite(log_fd_, log_data + done, size - done, log_size_ + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      LOG_DEBUG("I/O error while writing log: %s", strerror(errno));
+      flush_log_ = false;
+      return false;
+    }
+    done += n;
+  }
+  // the log is only durable once the data is on disk, the file's metadata is not needed to read it back
+#if defined(__linux__)
+  const int synced = fdatasync(log_fd_);
+#else
+  // fdatasync() is not available everywhere, fsync() also syncs the metadata
+  const int synced = fsync(log_fd_);
+#endif
+  if (synced != 0) {
+    LOG_DEBUG("I/O error while syncing log: %s", strerror(errno));
+    flush_log_ = false;
+    return false;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  log_size_ += size;
   flush_log_ = false;
+  return true;
 }
 
 /**
@@ -162,23 +413,27 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * @return: false means already reach the end
  */
 auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
-  if (offset >= GetFileSize(log_name_)) {
-    // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+  if (offset >= log_size_) {
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+  int done = 0;
+  while (done < size) {
+    const ssize_t n = pread(log_fd_, log_data + done, size - done, offset + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      LOG_DEBUG("I/O error while reading log: %s", strerror(errno));
+      return false;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += n;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+  if (done < size) {
+    memset(log_data + done, 0, size - done);
   }
 
   return true;
@@ -199,6 +454,195 @@ auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
  */
 auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 
+auto DiskManager::DoPageIO(bool write, page_id_t page_id, char *page_data) -> ssize_t {
+  if (direct_io_ && reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT != 0) {
+    alignas(DIRECT_IO_ALIGNMENT) static thread_local char bounce[BUSTUB_PAGE_SIZE];
+    if (write) {
+      memcpy(bounce, page_data, BUSTUB_PAGE_SIZE);
+      return DoPageIO(true, page_id, bounce);
+    }
+    const ssize_t result = DoPageIO(false, page_id, bounce);
+    if (result > 0) {
+      memcpy(page_data, bounce, result);
+    }
+    return result;
+  }
+
+  const off_t offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  size_t done = 0;
+  while (done < BUSTUB_PAGE_SIZE) {
+    const ssize_t n = write ? pwrite(db_fd_, page_data + done, BUSTUB_PAGE_SIZE - done, offset + done)
+                            : pread(db_fd_, page_data + done, BUSTUB_PAGE_SIZE - done, offset + done);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -errno;
+    }
+    if (n == 0) {
+      // end of file
+      break;
+    }
+    done += n;
+  }
+  return static_cast<ssize_t>(done);
+}
+
+void DiskManager::FinishPageIO(bool write, page_id_t page_id, char *page_data, ssize_t result) {
+  if (write && result != BUSTUB_PAGE_SIZE) {
+    // The caller has to keep the page, e.g. its frame dirty, since the disk does not have it.
+    const std::string error = result < 0 ? strerror(static_cast<int>(-result)) : "short write";
+    LOG_WARN("I/O error while writing page %d of %s: %s", page_id, file_name_.c_str(), error.c_str());
+    throw Exception(ExceptionType::IO_ERROR, fmt::format("can't write page {} of {}: {}", page_id, file_name_, error));
+  }
+  if (result < 0) {
+    LOG_DEBUG("I/O error while reading page %d: %s", page_id, strerror(static_cast<int>(-result)));
+    return;
+  }
+  if (!write) {
+    // if file ends before reading BUSTUB_PAGE_SIZE
+    if (result < BUSTUB_PAGE_SIZE) {
+      LOG_DEBUG("Read less than a page");
+      memset(page_data + result, 0, BUSTUB_PAGE_SIZE - result);
+    }
+    if (checksum_fd_ < 0) {
+      return;
+    }
+    uint32_t stored = 0;
+    {
+      std::shared_lock lock(checksums_latch_);
+      if (static_cast<size_t>(page_id) < num_checksums_) {
+        stored = checksums_[page_id];
+      }
+    }
+    if (stored == 0) {
+      return;
+    }
+    const uint32_t actual = PageChecksum(page_data);
+    if (stored != actual) {
+      num_checksum_failures_ += 1;
+      LOG_WARN("page %d of %s does not match its checksum", page_id, file_name_.c_str());
+      throw Exception(ExceptionType::DATA_CORRUPTION,
+                      fmt::format("page {} of {} is corrupt: checksum {:#010x}, expected {:#010x}", page_id,
+                                  file_name_, actual, stored));
+    }
+    return;
+  }
+  // Grow the cached file size to cover the page, unless a concurrent write grew it further already.
+  const int64_t end = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE + result;
+  int64_t size = db_file_size_.load(std::memory_order_relaxed);
+  while (size < end && !db_file_size_.compare_exchange_weak(size, end, std::memory_order_release)) {
+  }
+  // The checksum goes last. A crash of the process in between leaves the new page with the old checksum, so it fails
+  // verification. Like the page, it is in the page cache once stored, but the kernel writes the two back in any order.
+  if (checksum_fd_ >= 0) {
+    const uint32_t checksum = PageChecksum(page_data);
+    std::shared_lock lock(checksums_latch_);
+    if (static_cast<size_t>(page_id) >= num_checksums_) {
+      lock.unlock();
+      std::unique_lock grow_lock(checksums_latch_);
+      // Grow geometrically, so that a growing database file is remapped O(log n) times.
+      const size_t num_checksums = std::max<size_t>(page_id + 1, 2 * num_checksums_);
+      if (static_cast<size_t>(page_id) >= num_checksums_ && !MapChecksums(num_checksums)) {
+        LOG_DEBUG("can't grow the checksum file: %s", strerror(errno));
+        return;
+      }
+      checksums_[page_id] = checksum;
+      return;
+    }
+    checksums_[page_id] = checksum;
+  }
+}
+
+auto DiskManager::MapChecksums(size_t num_checksums) -> bool {
+  // Map whole OS pages, the checksums past the end of the database file stay 0.
+  const auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t size =
+      ((CHECKSUM_HEADER_SIZE + num_checksums) * sizeof(uint32_t) + os_page_size - 1) / os_page_size * os_page_size;
+  struct stat stat_buf;
+  if (fstat(checksum_fd_, &stat_buf) != 0 ||
+      (static_cast<size_t>(stat_buf.st_size) < size && ftruncate(checksum_fd_, static_cast<off_t>(size)) != 0)) {
+    return false;
+  }
+  void *checksums = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, checksum_fd_, 0);
+  if (checksums == MAP_FAILED) {
+    return false;
+  }
+  if (checksum_file_ != nullptr) {
+    munmap(checksum_file_, (CHECKSUM_HEADER_SIZE + num_checksums_) * sizeof(uint32_t));
+  }
+  checksum_file_ = static_cast<uint32_t *>(checksums);
+  checksums_ = checksum_file_ + CHECKSUM_HEADER_SIZE;
+  num_checksums_ = size / sizeof(uint32_t) - CHECKSUM_HEADER_SIZE;
+  return true;
+}
+
+void DiskManager::MarkChecksumsStale() {
+  if (checksums_stale_.load(std::memory_order_relaxed) || checksums_stale_.exchange(true)) {
+    return;
+  }
+  const std::string checksum_name = file_name_.substr(0, file_name_.rfind('.')) + ".crc";
+  const int fd = open(checksum_name.c_str(), O_WRONLY);
+  if (fd < 0) {
+    // There are no checksums to go stale.
+    return;
+  }
+  const uint32_t stale = 1;
+  if (pwrite(fd, &stale, sizeof(stale), 0) != sizeof(stale)) {
+    LOG_WARN("can't mark the checksums of %s stale: %s", file_name_.c_str(), strerror(errno));
+  }
+  close(fd);
+}
+
+void DiskManager::SetPagesAllocated(page_id_t first_page_id, size_t num_pages, bool allocated) {
+  const size_t first_index = first_page_id / 8;
+  const size_t last_index = (first_page_id + num_pages - 1) / 8;
+  if (last_index >= allocated_.size()) {
+    allocated_.resize(std::max(last_index + 1, 2 * allocated_.size()));
+  }
+  for (size_t page_id = first_page_id; page_id < first_page_id + num_pages; page_id++) {
+    if (allocated) {
+      allocated_[page_id / 8] |= 1U << (page_id % 8);
+    } else {
+      allocated_[page_id / 8] &= ~(1U << (page_id % 8));
+    }
+  }
+  const size_t size = last_index - first_index + 1;
+  if (fsm_fd_ >= 0 &&
+      pwrite(fsm_fd_, &allocated_[first_index], size, static_cast<off_t>(first_index)) != static_cast<ssize_t>(size)) {
+    LOG_DEBUG("can't write the free-page bitmap file: %s", strerror(errno));
+  }
+}
+
+auto DiskManager::StripeFreePages(uint32_t stride) -> std::vector<std::set<page_id_t>> & {
+  auto [it, inserted] = stripe_free_pages_.try_emplace(stride, stride);
+  if (inserted) {
+    for (auto page_id : free_pages_) {
+      it->second[static_cast<uint32_t>(page_id) % stride].insert(page_id);
+    }
+  }
+  return it->second;
+}
+
+void DiskManager::InsertFreePage(page_id_t page_id) {
+  free_pages_.insert(page_id);
+  for (auto &[stride, free_pages] : stripe_free_pages_) {
+    free_pages[static_cast<uint32_t>(page_id) % stride].insert(page_id);
+  }
+}
+
+void DiskManager::EraseFreePage(page_id_t page_id) {
+  free_pages_.erase(page_id);
+  for (auto &[stride, free_pages] : stripe_free_pages_) {
+    free_pages[static_cast<uint32_t>(page_id) % stride].erase(page_id);
+  }
+}
+
+auto DiskManager::PageChecksum(const char *page_data) -> uint32_t {
+  const uint32_t checksum = Crc32c::Compute(page_data, BUSTUB_PAGE_SIZE);
+  return checksum == 0 ? 1 : checksum;
+}
+
 /**
  * Private helper function to get disk file size
  */
@@ -27,7 +27,7 @@ namespace bustub {
 /**
  * Constructor: used for memory based manager
  */
-DiskManagerMemory::DiskManagerMemory(size_t pages) { memory_ = new char[pages * BUSTUB_PAGE_SIZE]; }
+DiskManagerMemory::DiskManagerMemory(size_t pages) : num_pages_(pages) { memory_ = new char[pages * BUSTUB_PAGE_SIZE]; }
 
 /**
  * Write the contents of the specified page into disk file
@@ -47,4 +47,17 @@ void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Zero the page before it is deallocated, so that it cannot overwrite a page that reuses its id
+ */
+void DiskManagerMemory::DeallocatePage(page_id_t page_id) {
+  // Only pages that were allocated are freed, and only those within the memory hold any data.
+  if (page_id < 0 || static_cast<size_t>(page_id) >= num_pages_ || !IsPageAllocated(page_id)) {
+    return;
+  }
+  int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
+  memset(memory_ + offset, 0, BUSTUB_PAGE_SIZE);
+  DiskManager::DeallocatePage(page_id);
+}
+
 }  // namespace bustub
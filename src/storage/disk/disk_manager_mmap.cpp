@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+static auto ToAdvice(MmapAccessPattern access_pattern) -> int {
+  switch (access_pattern) {
+    case MmapAccessPattern::SEQUENTIAL:
+      return MADV_SEQUENTIAL;
+    case MmapAccessPattern::RANDOM:
+      return MADV_RANDOM;
+    case MmapAccessPattern::NORMAL:
+      break;
+  }
+  return MADV_NORMAL;
+}
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file, MmapAccessPattern access_pattern) {
+  file_name_ = db_file;
+  const int fd = open(db_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0) {
+    close(fd);
+    throw Exception("can't stat db file");
+  }
+  // A partial page at the end of the file cannot have been written by a DiskManager, so it is left out.
+  size_ = static_cast<size_t>(stat_buf.st_size) / BUSTUB_PAGE_SIZE * BUSTUB_PAGE_SIZE;
+  if (size_ > 0) {
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map db file");
+    }
+    data_ = static_cast<char *>(data);
+  }
+  // The mapping keeps the file open.
+  close(fd);
+  db_file_size_ = static_cast<int64_t>(size_);
+  SetAccessPattern(access_pattern);
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  throw Exception(ExceptionType::NOT_IMPLEMENTED, "can't write page " + std::to_string(page_id) +
+                                                      " of a database file that is mapped read-only");
+}
+
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  const char *data = GetPageData(page_id);
+  if (data == nullptr) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  memcpy(page_data, data, BUSTUB_PAGE_SIZE);
+}
+
+auto DiskManagerMmap::GetPageData(page_id_t page_id) const -> const char * {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= GetNumPages()) {
+    return nullptr;
+  }
+  return data_ + static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+}
+
+void DiskManagerMmap::SetAccessPattern(MmapAccessPattern access_pattern) {
+  if (data_ != nullptr) {
+    madvise(data_, size_, ToAdvice(access_pattern));
+  }
+}
+
+void DiskManagerMmap::WillNeed(page_id_t first_page_id, size_t num_pages) {
+  if (first_page_id < 0 || static_cast<size_t>(first_page_id) >= GetNumPages()) {
+    return;
+  }
+  num_pages = std::min(num_pages, GetNumPages() - static_cast<size_t>(first_page_id));
+  madvise(data_ + static_cast<size_t>(first_page_id) * BUSTUB_PAGE_SIZE, num_pages * BUSTUB_PAGE_SIZE,
+          MADV_WILLNEED);
+}
+
+}  // namespace bustub
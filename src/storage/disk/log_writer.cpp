@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_writer.cpp
+//
+// Identification: src/storage/disk/log_writer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/log_writer.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+LogWriter::LogWriter(DiskManager *disk_manager, size_t buffer_size)
+    : disk_manager_(disk_manager),
+      buffer_size_(buffer_size),
+      log_buffer_(new char[buffer_size]),
+      flush_buffer_(new char[buffer_size]) {
+  writer_thread_ = std::thread(&LogWriter::RunWriter, this);
+}
+
+LogWriter::~LogWriter() {
+  {
+    std::scoped_lock lock(latch_);
+    stop_ = true;
+  }
+  writer_cv_.notify_one();
+  writer_thread_.join();
+  delete[] log_buffer_;
+  delete[] flush_buffer_;
+}
+
+auto LogWriter::Append(const char *record, size_t size) -> lsn_t {
+  if (size > buffer_size_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE,
+                    "log record of " + std::to_string(size) + " bytes does not fit into the log buffer");
+  }
+
+  std::unique_lock lock(latch_);
+  // Wait for the log writer thread to swap the buffers.
+  while (!failed_ && log_buffer_used_ + size > buffer_size_) {
+    writer_cv_.notify_one();
+    durable_cv_.wait(lock);
+  }
+  if (failed_) {
+    throw Exception("can't append to the log after a failed log write");
+  }
+  memcpy(log_buffer_ + log_buffer_used_, record, size);
+  log_buffer_used_ += size;
+  return next_lsn_++;
+}
+
+auto LogWriter::WaitDurable(lsn_t lsn) -> lsn_t {
+  std::unique_lock lock(latch_);
+  if (durable_lsn_ < lsn) {
+    num_waiters_++;
+    writer_cv_.notify_one();
+    durable_cv_.wait(lock, [&] { return durable_lsn_ >= lsn || failed_; });
+    num_waiters_--;
+  }
+  if (durable_lsn_ < lsn) {
+    throw Exception("can't make log record " + std::to_string(lsn) + " durable");
+  }
+  return durable_lsn_;
+}
+
+auto LogWriter::GetDurableLSN() -> lsn_t {
+  std::scoped_lock lock(latch_);
+  return durable_lsn_;
+}
+
+auto LogWriter::GetNumSyncs() -> size_t {
+  std::scoped_lock lock(latch_);
+  return num_syncs_;
+}
+
+void LogWriter::RunWriter() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    // Committers waiting means a sync right away. Everything that arrives during the sync goes into the next one.
+    writer_cv_.wait_for(lock, log_timeout, [&] {
+      return stop_ || (log_buffer_used_ > 0 && (num_waiters_ > 0 || log_buffer_used_ >= buffer_size_ / 2));
+    });
+    if (log_buffer_used_ == 0 || failed_) {
+      if (stop_) {
+        return;
+      }
+      continue;
+    }
+
+    std::swap(log_buffer_, flush_buffer_);
+    const auto size = static_cast<int>(log_buffer_used_);
+    const lsn_t last_lsn = next_lsn_ - 1;
+    log_buffer_used_ = 0;
+    // Appenders that waited for room can go on.
+    durable_cv_.notify_all();
+
+    lock.unlock();
+    const bool ok = disk_manager_->WriteLog(flush_buffer_, size);
+    lock.lock();
+
+    num_syncs_++;
+    if (ok) {
+      durable_lsn_ = last_lsn;
+    } else {
+      failed_ = true;
+    }
+    durable_cv_.notify_all();
+  }
+}
+
+}  // namespace bustub
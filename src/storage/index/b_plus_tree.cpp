@@ -48,8 +48,8 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
 
-  auto leaf_page = FindLeaf(key, transaction);
-  auto *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  WritePageGuard leaf_guard = FindLeaf(key, transaction).UpgradeWrite();
+  auto *leaf_node = leaf_guard.AsMut<LeafPage>();
 
   // Now we're in the right leaf page. Insert the key/value pair into leaf page.
   // Split might happen after insertion.
@@ -117,7 +117,8 @@ auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t { return 0; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  auto *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  auto header_guard = buffer_pool_manager_->FetchPageWrite(HEADER_PAGE_ID);
+  auto *header_page = static_cast<HeaderPage *>(header_guard.GetPage());
   if (insert_record != 0) {
     // create a new record<index_name + root_page_id> in header_page
     header_page->InsertRecord(index_name_, root_page_id_);
@@ -125,7 +126,7 @@ void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  header_guard.SetDirty();
 }
 
 /*
@@ -162,22 +163,45 @@ void BPLUSTREE_TYPE::RemoveFromFile(const std::string &file_name, Transaction *t
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::FindLeaf(const KeyType &key, Transaction *transaction) -> Page * {
-  auto page = buffer_pool_manager_->FetchPage(root_page_id_);
+auto BPLUSTREE_TYPE::FindLeaf(const KeyType &key, Transaction *transaction) -> BasicPageGuard {
+  auto guard = buffer_pool_manager_->FetchPageBasic(root_page_id_);
 
   // root node could be either internal node or leaf node
-  auto *p = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  page_id_t child_page_id;
+  while (FindChildOptimistic(guard.GetPage(), key, &child_page_id)) {
+    // The child is pinned before the assignment unpins its parent.
+    guard = buffer_pool_manager_->FetchPageBasic(child_page_id);
+  }
 
-  while (!p->IsLeafPage()) {
-    auto *internal_node = reinterpret_cast<InternalPage *>(p);
-    auto child_page_id = internal_node->FindChild(key, comparator_);
+  return guard;
+}
 
-    buffer_pool_manager_->UnpinPage(p->GetPageId(), false);
-    page = buffer_pool_manager_->FetchPage(child_page_id);
-    p = reinterpret_cast<BPlusTreePage *>(page->GetData());
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindChildOptimistic(Page *page, const KeyType &key, page_id_t *child_page_id) -> bool {
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+
+  // Readers only look at an internal page to pick a child, so they do not need to keep writers out. The pin keeps the
+  // frame from being reused, so a torn read can only produce a bogus size, which is checked before searching.
+  uint64_t version;
+  if (page->TryOptimisticRLatch(&version)) {
+    const bool is_leaf = node->IsLeafPage();
+    const int size = node->GetSize();
+    const bool searchable = is_leaf || (size > 0 && size <= static_cast<int>(INTERNAL_PAGE_SIZE));
+    if (!is_leaf && searchable) {
+      *child_page_id = reinterpret_cast<InternalPage *>(node)->FindChild(key, comparator_);
+    }
+    if (page->ValidateOptimisticRLatch(version) && searchable) {
+      return !is_leaf;
+    }
   }
 
-  return page;
+  page->RLatch();
+  const bool is_leaf = node->IsLeafPage();
+  if (!is_leaf) {
+    *child_page_id = reinterpret_cast<InternalPage *>(node)->FindChild(key, comparator_);
+  }
+  page->RUnlatch();
+  return !is_leaf;
 }
 
 
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_trace_test.cpp
+//
+// Identification: test/buffer/access_trace_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/access_trace.h"
+
+#include <sstream>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(AccessTraceTest, SampleTest) {
+  AccessTrace trace(4);
+
+  // Scenario: The trace keeps the most recent accesses, oldest first.
+  for (page_id_t i = 0; i < 6; ++i) {
+    trace.Record(AccessType::FETCH, i);
+  }
+  trace.Record(AccessType::DELETE, 5);
+  std::vector<AccessRecord> expected{
+      {AccessType::FETCH, 3}, {AccessType::FETCH, 4}, {AccessType::FETCH, 5}, {AccessType::DELETE, 5}};
+  EXPECT_EQ(expected, trace.Snapshot());
+  EXPECT_EQ(7, trace.GetNumRecorded());
+
+  // Scenario: The written trace reads back to the same accesses.
+  std::stringstream ss;
+  EXPECT_EQ(4, trace.WriteTo(ss));
+  EXPECT_EQ("F 3\nF 4\nF 5\nD 5\n", ss.str());
+  EXPECT_EQ(expected, AccessTrace::ReadFrom(ss));
+
+  // Scenario: Clearing forgets the accesses recorded so far.
+  trace.Clear();
+  EXPECT_TRUE(trace.Snapshot().empty());
+  trace.Record(AccessType::NEW, 7);
+  EXPECT_EQ((std::vector<AccessRecord>{{AccessType::NEW, 7}}), trace.Snapshot());
+
+  // Scenario: Comments and empty lines are skipped, malformed lines are rejected.
+  std::stringstream comments("# recorded by bpstats\n\nN 1\nF 1\n");
+  EXPECT_EQ((std::vector<AccessRecord>{{AccessType::NEW, 1}, {AccessType::FETCH, 1}}), AccessTrace::ReadFrom(comments));
+  std::stringstream malformed("F 1\nX 2\n");
+  EXPECT_THROW(AccessTrace::ReadFrom(malformed), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST(AccessTraceTest, ConcurrentRecordTest) {
+  const int num_threads = 4;
+  const int num_records = 10000;
+  AccessTrace trace(num_threads * num_records);
+
+  // Scenario: Concurrent recorders lose no accesses, and each thread's accesses stay in order.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&trace, tid] {
+      for (int i = 0; i < num_records; i++) {
+        trace.Record(AccessType::FETCH, tid * num_records + i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto records = trace.Snapshot();
+  ASSERT_EQ(num_threads * num_records, records.size());
+  std::vector<page_id_t> last(num_threads, -1);
+  for (const auto &record : records) {
+    const int tid = record.page_id_ / num_records;
+    EXPECT_LT(last[tid], record.page_id_);
+    last[tid] = record.page_id_;
+  }
+}
+
+}  // namespace bustub
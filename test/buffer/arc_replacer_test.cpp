@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Load a page into a frame and unpin it, like the buffer pool does on a miss. */
+void LoadPage(ArcReplacer *replacer, frame_id_t frame_id, page_id_t page_id) {
+  replacer->SetPageId(frame_id, page_id);
+  replacer->RecordAccess(frame_id);
+  replacer->SetEvictable(frame_id, true);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ArcReplacerTest, SampleTest) {
+  ArcReplacer arc_replacer(4);
+
+  // Scenario: load pages 10 to 13 into frames 0 to 3, and access page 10 again. T1 is [11, 12, 13], T2 is [10].
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    LoadPage(&arc_replacer, frame_id, 10 + frame_id);
+  }
+  arc_replacer.RecordAccess(0);
+  ASSERT_EQ(4, arc_replacer.Size());
+  ASSERT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // Scenario: T1 is above its target size, so its LRU frame goes, and page 11 becomes a ghost in B1.
+  frame_id_t frame_id;
+  ASSERT_TRUE(arc_replacer.Evict(&frame_id));
+  ASSERT_EQ(1, frame_id);
+
+  // Scenario: page 11 comes back while it is in B1. T1 should have been larger, and the page goes into T2.
+  LoadPage(&arc_replacer, 1, 11);
+  ASSERT_EQ(1, arc_replacer.GetTargetT1Size());
+  // T1 is [12, 13], T2 is [10, 11]. Once T1 is down to its target size, the victims come from T2.
+  ASSERT_EQ(std::vector<frame_id_t>({2, 0, 1, 3}), arc_replacer.EvictionCandidates(4));
+
+  // Scenario: evict page 12 into B1 and page 10 into B2. Page 10 comes back, so T2 should have been larger.
+  ASSERT_TRUE(arc_replacer.Evict(&frame_id));
+  ASSERT_EQ(2, frame_id);
+  ASSERT_TRUE(arc_replacer.Evict(&frame_id));
+  ASSERT_EQ(0, frame_id);
+  LoadPage(&arc_replacer, 0, 10);
+  ASSERT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // Scenario: T1 is [13], T2 is [11, 10]. Pin frame 3, so the victim has to come from T2.
+  arc_replacer.SetEvictable(3, false);
+  ASSERT_TRUE(arc_replacer.Evict(&frame_id));
+  ASSERT_EQ(1, frame_id);
+  ASSERT_EQ(1, arc_replacer.Size());
+
+  // Scenario: removing page 10 does not turn it into a ghost, so it starts over in T1. Page 11 is in B2, and goes back
+  // into T2.
+  arc_replacer.Remove(0);
+  LoadPage(&arc_replacer, 0, 10);
+  LoadPage(&arc_replacer, 1, 11);
+  arc_replacer.SetEvictable(3, true);
+  ASSERT_EQ(std::vector<frame_id_t>({3, 0, 1}), arc_replacer.EvictionCandidates(4));
+  ASSERT_EQ(3, arc_replacer.Size());
+
+  EXPECT_THROW(arc_replacer.RecordAccess(4), Exception);
+}
+
+}  // namespace bustub
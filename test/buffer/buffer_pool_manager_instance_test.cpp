@@ -12,12 +12,18 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -148,4 +154,622 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Check that frames freed by DeletePage are accounted for when deciding whether a frame is available
+TEST(BufferPoolManagerInstanceTest, DeletePageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: A pinned page cannot be deleted, an unpinned page can.
+  EXPECT_EQ(false, bpm->DeletePage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->DeletePage(0));
+
+  // Scenario: The deleted page's frame and page id are reused, after which the pool is full again.
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp);
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Unpinning a page makes exactly one frame available.
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+
+  // Scenario: Deleting pages that are not resident and were never allocated leaves a memory-backed disk alone, also
+  // past the end of its memory.
+  DiskManagerMemory memory_disk_manager(buffer_pool_size);
+  BufferPoolManagerInstance memory_bpm(buffer_pool_size, &memory_disk_manager, k);
+  auto *page = memory_bpm.NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(true, memory_bpm.UnpinPage(page_id_temp, true));
+  EXPECT_EQ(true, memory_bpm.FlushPage(page_id_temp));
+  EXPECT_EQ(true, memory_bpm.DeletePage(1));
+  EXPECT_EQ(true, memory_bpm.DeletePage(1 << 20));
+  char data[BUSTUB_PAGE_SIZE];
+  memory_disk_manager.ReadPage(page_id_temp, data);
+  EXPECT_EQ(std::string("Hello"), std::string(data));
+}
+
+// NOLINTNEXTLINE
+// Check that the background flusher writes back dirty victims, so that evicting them does not write
+TEST(BufferPoolManagerInstanceTest, BackgroundFlushTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  bpm->StartBackgroundFlusher(buffer_pool_size);
+
+  // Scenario: Fill the buffer pool with dirty, unpinned pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The flusher cleans every frame, since they are all among the next victims.
+  Page *pages = bpm->GetPages();
+  auto all_clean = [&]() {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (pages[i].IsDirty()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int retry = 0; retry < 100 && !all_clean(); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(all_clean());
+
+  // Scenario: Evicting the clean pages does not write anything, and their contents made it to disk.
+  int num_writes = disk_manager->GetNumWrites();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+
+  char data[BUSTUB_PAGE_SIZE];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    disk_manager->ReadPage(static_cast<page_id_t>(i), data);
+    EXPECT_EQ("page " + std::to_string(i), std::string(data));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** A disk manager that takes a long time to read one particular page. */
+class SlowReadDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit SlowReadDiskManager(page_id_t slow_page_id) : slow_page_id_(slow_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_++;
+    if (page_id == slow_page_id_) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  auto GetNumReads() const -> int { return num_reads_; }
+
+ private:
+  page_id_t slow_page_id_;
+  std::atomic<int> num_reads_{0};
+};
+
+// NOLINTNEXTLINE
+// Check that a slow read on a miss neither blocks hits on other pages nor lets a concurrent fetch see a partial page
+TEST(BufferPoolManagerInstanceTest, ReadWithoutLatchTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  const page_id_t cold_page_id = 0;
+
+  auto *disk_manager = new SlowReadDiskManager(cold_page_id);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: Write the cold page and push it out of the buffer pool, while keeping one hot page around.
+  page_id_t page_id_temp;
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "cold");
+  EXPECT_EQ(true, bpm->UnpinPage(cold_page_id, true));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  const page_id_t hot_page_id = page_id_temp;
+
+  // Scenario: Two threads fetch the cold page at the same time. Both get the fully read page.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; ++i) {
+    threads.emplace_back([bpm]() {
+      auto *cold_page = bpm->FetchPage(cold_page_id);
+      ASSERT_NE(nullptr, cold_page);
+      EXPECT_EQ(0, strcmp(cold_page->GetData(), "cold"));
+      EXPECT_EQ(true, bpm->UnpinPage(cold_page_id, false));
+    });
+  }
+
+  // Scenario: Meanwhile, fetching the hot page does not wait for the slow read.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_NE(nullptr, bpm->FetchPage(hot_page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(hot_page_id, false));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+
+// NOLINTNEXTLINE
+// Check that prefetching does not block on the reads, and that prefetched pages are fetched without reading them again
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  const page_id_t slow_page_id = 0;
+
+  auto *disk_manager = new SlowReadDiskManager(slow_page_id);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: Write a few pages and push them out of the buffer pool.
+  const page_id_t num_prefetched = 5;
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_prefetched; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: Prefetching returns right away, even though reading page 0 is slow.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t i = 0; i < num_prefetched; ++i) {
+    page_ids.push_back(i);
+  }
+  auto start = std::chrono::steady_clock::now();
+  bpm->PrefetchPages(page_ids);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(200));
+
+  // Scenario: Fetching a page that is still being prefetched waits for the read instead of returning a partial page.
+  for (page_id_t i = 0; i < num_prefetched; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: Once read, prefetched pages are not pinned, so the whole buffer pool can be reused.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that a scan through a buffer ring does not flush the pages of other queries out of the buffer pool
+TEST(BufferPoolManagerInstanceTest, BufferRingTest) {
+  const size_t buffer_pool_size = 16;
+
+  auto *disk_manager = new SlowReadDiskManager(INVALID_PAGE_ID);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: Create a table that is twice as large as the buffer pool, followed by a few pages in frequent use.
+  const page_id_t num_scanned = 2 * buffer_pool_size;
+  const page_id_t num_hot = 8;
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_scanned + num_hot; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (int round = 0; round < 2; ++round) {
+    for (page_id_t i = num_scanned; i < num_scanned + num_hot; ++i) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+  }
+  EXPECT_EQ(0, disk_manager->GetNumReads());
+
+  // Scenario: Scan the whole table through a ring. Every page is read, and reads back what was written.
+  BufferRing ring;
+  for (page_id_t i = 0; i < num_scanned; ++i) {
+    auto *page = bpm->FetchPageBulk(i, &ring);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  const int num_reads = disk_manager->GetNumReads();
+  EXPECT_LE(num_scanned - static_cast<page_id_t>(buffer_pool_size), num_reads);
+
+  // Scenario: The pages in frequent use are all still in the buffer pool.
+  for (page_id_t i = num_scanned; i < num_scanned + num_hot; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_reads, disk_manager->GetNumReads());
+
+  // Scenario: A ring still makes progress when the frame it would reuse is pinned.
+  auto *pinned = bpm->FetchPageBulk(0, &ring);
+  ASSERT_NE(nullptr, pinned);
+  for (page_id_t i = 1; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPageBulk(i, &ring));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(0, strcmp(pinned->GetData(), "0"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const size_t buffer_pool_size = 3;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  AccessTrace trace(16);
+  bpm->SetAccessTrace(&trace);
+
+  // Scenario: Fill the buffer pool with dirty pages, then fetch them again while they are resident.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+
+  // Scenario: Every frame is pinned, so the next new page and the fetch of an evicted page fail.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: Creating new pages evicts page 0 and writes it back. The new pages have fewer than k accesses, so they
+  // evict each other after that. Reading page 0 again misses.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->DeletePage(0));
+
+  stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(0.75, stats.HitRatio());
+  EXPECT_EQ(4, stats.evictions_);
+  EXPECT_EQ(1, stats.write_backs_);
+  EXPECT_EQ(1, stats.failed_fetches_);
+  EXPECT_EQ(0, stats.pin_waits_);
+  EXPECT_GT(stats.LatchHolds(), 0);
+  EXPECT_GE(stats.LatchHoldPercentile(99), stats.LatchHoldPercentile(50));
+
+  // Scenario: The trace has the successful new pages, every fetch and the delete, in order.
+  std::vector<AccessRecord> expected;
+  for (page_id_t i = 0; i < 3; ++i) {
+    expected.push_back({AccessType::NEW, i});
+  }
+  for (page_id_t i = 0; i < 3; ++i) {
+    expected.push_back({AccessType::FETCH, i});
+  }
+  for (page_id_t i = 3; i < 6; ++i) {
+    expected.push_back({AccessType::NEW, i});
+  }
+  expected.push_back({AccessType::FETCH, 0});
+  expected.push_back({AccessType::DELETE, 0});
+  EXPECT_EQ(expected, trace.Snapshot());
+
+  bpm->SetAccessTrace(nullptr);
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(expected.size(), trace.GetNumRecorded());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 8;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, max_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+
+  // Scenario: Fill the buffer pool with pinned pages.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", i);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Growing the buffer pool makes room for more pages, up to the maximum size.
+  EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+  EXPECT_FALSE(bpm->Resize(0));
+  ASSERT_TRUE(bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (page_id_t i = static_cast<page_id_t>(buffer_pool_size); i < static_cast<page_id_t>(max_pool_size); ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", i);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Shrinking fails without any change while a frame that would go away is pinned.
+  EXPECT_FALSE(bpm->Resize(2));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+
+  // Scenario: Keep pages 0 and 1 pinned, and delete pages 2 and 3 so that their frames are free. Shrinking to four
+  // frames moves two pages of the frames that go away into the free frames, and evicts the other two.
+  for (page_id_t i = 2; i < static_cast<page_id_t>(max_pool_size); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(2, bpm->GetStats().evictions_);
+  EXPECT_EQ(2, bpm->GetStats().write_backs_);
+  for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+    EXPECT_EQ(INVALID_PAGE_ID, bpm->GetPages()[i].GetPageId());
+  }
+
+  // Scenario: Every page still reads back its data, whether it was moved, evicted or never touched.
+  for (page_id_t i = 4; i < static_cast<page_id_t>(max_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+    EXPECT_LT(page - bpm->GetPages(), static_cast<ptrdiff_t>(buffer_pool_size));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  for (page_id_t i = 0; i < 2; ++i) {
+    EXPECT_EQ(std::to_string(i), std::string(bpm->FetchPage(i)->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: The frames of the smaller buffer pool can all be used.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: Write twelve pages, so that only the last eight stay in the buffer pool.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < 12; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: A batch with hits, misses and a page that appears twice returns every page, and takes the latch a constant
+  // number of times instead of once per page.
+  std::vector<page_id_t> page_ids{11, 1, 10, 0, 1};
+  auto stats = bpm->GetStats();
+  auto pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[1], pages[4]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+  EXPECT_EQ(stats.hits_ + 3, bpm->GetStats().hits_);
+  EXPECT_EQ(stats.misses_ + 2, bpm->GetStats().misses_);
+  EXPECT_GE(stats.LatchHolds() + 3, bpm->GetStats().LatchHolds());
+
+  // Scenario: With only four frames left to admit pages into, a batch of six misses fetches the first four and returns
+  // nullptr for the rest.
+  auto more_pages = bpm->FetchPages({2, 3, 4, 5, 6, 7});
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, more_pages[i]);
+    EXPECT_EQ(std::to_string(i + 2), std::string(more_pages[i]->GetData()));
+  }
+  EXPECT_EQ(nullptr, more_pages[4]);
+  EXPECT_EQ(nullptr, more_pages[5]);
+
+  // Scenario: Each page is pinned once per time it was asked for.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 2; page_id < 6; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReplacerPolicyTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k, nullptr, 0, ReplacerPolicy::ARC);
+  EXPECT_EQ(ReplacerPolicy::ARC, bpm->GetReplacerPolicy());
+
+  // Scenario: Fill the buffer pool. Page 0 stays pinned, page 3 is accessed again.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", i);
+    if (i > 0) {
+      EXPECT_EQ(true, bpm->UnpinPage(i, true));
+    }
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+
+  // Scenario: Switch to 2Q while the pool is full. The new replacer knows which frames are pinned.
+  ASSERT_TRUE(bpm->SetReplacerPolicy(ReplacerPolicy::TWO_Q));
+  EXPECT_EQ(ReplacerPolicy::TWO_Q, bpm->GetReplacerPolicy());
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(std::string("0"), std::string(bpm->FetchPage(0)->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: Unpin everything and switch to every other policy. The evicted pages read back their data.
+  for (page_id_t i = static_cast<page_id_t>(buffer_pool_size); i <= page_id_temp; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::LRU_K}) {
+    ASSERT_TRUE(bpm->SetReplacerPolicy(policy));
+    for (page_id_t i = 1; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** A disk manager that finds one particular page corrupt, after taking a while to read it. */
+class CorruptPageDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit CorruptPageDiskManager(page_id_t corrupt_page_id) : corrupt_page_id_(corrupt_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == corrupt_page_id_) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      throw Exception(ExceptionType::DATA_CORRUPTION, "corrupt page");
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+ private:
+  page_id_t corrupt_page_id_;
+};
+
+// NOLINTNEXTLINE
+// Check that a page the disk manager finds corrupt cannot be fetched, and does not leak its frame
+TEST(BufferPoolManagerInstanceTest, CorruptPageTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+  const page_id_t corrupt_page_id = 1;
+
+  auto *disk_manager = new CorruptPageDiskManager(corrupt_page_id);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: Write eight pages, so that pages 0 to 3 are only on disk.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < 8; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Neither the fetcher that reads the corrupt page nor a fetcher that waits for that read gets the page.
+  std::thread reader([&] { EXPECT_EQ(nullptr, bpm->FetchPage(corrupt_page_id)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(nullptr, bpm->FetchPage(corrupt_page_id));
+  reader.join();
+
+  // Scenario: A batch returns nullptr for the corrupt page, every time it is asked for, and the other pages as usual.
+  auto pages = bpm->FetchPages({0, corrupt_page_id, 2, corrupt_page_id});
+  ASSERT_NE(nullptr, pages[0]);
+  EXPECT_EQ(std::string("0"), std::string(pages[0]->GetData()));
+  EXPECT_EQ(nullptr, pages[1]);
+  ASSERT_NE(nullptr, pages[2]);
+  EXPECT_EQ(std::string("2"), std::string(pages[2]->GetData()));
+  EXPECT_EQ(nullptr, pages[3]);
+
+  // Scenario: So does a fetch after prefetching the corrupt page.
+  bpm->PrefetchPages({corrupt_page_id, 3});
+  EXPECT_EQ(nullptr, bpm->FetchPage(corrupt_page_id));
+  auto *page = bpm->FetchPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(std::string("3"), std::string(page->GetData()));
+
+  // Scenario: The frames of the failed reads are free again, so the whole buffer pool can be reused.
+  for (page_id_t page_id : {0, 2, 3}) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
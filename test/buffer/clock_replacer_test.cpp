@@ -10,53 +10,116 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <cstdio>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/clock_replacer.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  clock_replacer.Unpin(1);
-  clock_replacer.Unpin(2);
-  clock_replacer.Unpin(3);
-  clock_replacer.Unpin(4);
-  clock_replacer.Unpin(5);
-  clock_replacer.Unpin(6);
-  clock_replacer.Unpin(1);
+  // Scenario: access six frames and unpin them, i.e. make them evictable. Then access frame 1 again.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    clock_replacer.RecordAccess(frame_id);
+    clock_replacer.SetEvictable(frame_id, true);
+  }
+  clock_replacer.RecordAccess(1);
   EXPECT_EQ(6, clock_replacer.Size());
 
-  // Scenario: get three victims from the clock.
+  // Scenario: get three victims from the clock. Every frame is referenced, so the first sweep clears all the reference
+  // bits and the victims come in the order of the hand.
   int value;
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(1, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(2, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(3, value);
 
   // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  clock_replacer.Pin(3);
-  clock_replacer.Pin(4);
+  // Note that 3 has already been evicted, so pinning 3 should have no effect.
+  clock_replacer.SetEvictable(3, false);
+  clock_replacer.SetEvictable(5, false);
   EXPECT_EQ(2, clock_replacer.Size());
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  clock_replacer.Unpin(4);
+  // Scenario: access 4. We expect that its reference bit gives it a second chance.
+  clock_replacer.RecordAccess(4);
+  EXPECT_EQ(std::vector<frame_id_t>({6, 4}), clock_replacer.EvictionCandidates(5));
 
-  // Scenario: continue looking for victims. We expect these victims.
-  clock_replacer.Victim(&value);
-  EXPECT_EQ(5, value);
-  clock_replacer.Victim(&value);
+  // Scenario: access 5 and unpin it, continue looking for victims. We expect these victims.
+  clock_replacer.RecordAccess(5);
+  clock_replacer.SetEvictable(5, true);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(6, value);
-  clock_replacer.Victim(&value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
   EXPECT_EQ(4, value);
+  ASSERT_TRUE(clock_replacer.Evict(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(clock_replacer.Evict(&value));
+
+  // Scenario: a frame that is not evictable cannot be removed, and frame ids out of range throw.
+  clock_replacer.RecordAccess(2);
+  clock_replacer.Remove(2);
+  clock_replacer.SetEvictable(2, true);
+  EXPECT_EQ(1, clock_replacer.Size());
+  clock_replacer.Remove(2);
+  EXPECT_EQ(0, clock_replacer.Size());
+  EXPECT_THROW(clock_replacer.RecordAccess(7), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, ConcurrencyTest) {
+  const size_t num_frames = 64;
+  const size_t num_threads = 4;
+  const size_t rounds = 20000;
+  ClockReplacer clock_replacer(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    clock_replacer.RecordAccess(static_cast<frame_id_t>(i));
+    clock_replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+  }
+
+  // Scenario: every thread owns the frames i with i % num_threads == tid, and keeps hitting them, while also evicting
+  // frames and putting them back. A frame that is evicted is not evictable until it is put back, so no two threads may
+  // get the same victim, and the evictable count must add up in the end.
+  std::vector<std::atomic<int>> evicted(num_frames);
+  std::atomic<bool> double_eviction{false};
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      for (size_t i = 0; i < rounds; i++) {
+        auto frame_id = static_cast<frame_id_t>((i * num_threads + tid) % num_frames);
+        clock_replacer.RecordAccess(frame_id);
+        if (i % 4 == 0) {
+          frame_id_t victim;
+          if (clock_replacer.Evict(&victim)) {
+            if (evicted[victim].fetch_add(1) != 0) {
+              double_eviction = true;
+            }
+            evicted[victim].fetch_sub(1);
+            clock_replacer.RecordAccess(victim);
+            clock_replacer.SetEvictable(victim, true);
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(double_eviction);
+  EXPECT_EQ(num_frames, clock_replacer.Size());
+  frame_id_t victim;
+  for (size_t i = 0; i < num_frames; i++) {
+    ASSERT_TRUE(clock_replacer.Evict(&victim));
+  }
+  EXPECT_FALSE(clock_replacer.Evict(&victim));
+  EXPECT_EQ(0, clock_replacer.Size());
 }
 
 }  // namespace bustub
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator_test.cpp
+//
+// Identification: test/buffer/extent_allocator_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/extent_allocator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, SampleTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t extent_size = 4;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+  auto table = std::make_unique<ExtentAllocator>(bpm.get(), extent_size);
+  auto index = std::make_unique<ExtentAllocator>(bpm.get(), extent_size);
+
+  // Scenario: two owners that grow at the same time each get contiguous runs of pages, not every other page.
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 6; i++) {
+    ASSERT_NE(nullptr, table->NewPage(&page_id));
+    EXPECT_EQ(i < 4 ? i : i + 4, page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    ASSERT_NE(nullptr, index->NewPage(&page_id));
+    EXPECT_EQ(i < 4 ? i + 4 : i + 8, page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: NewPage() allocates single pages past the extents.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(16, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: a page that cannot be created keeps its id for the next attempt.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+  EXPECT_EQ(nullptr, table->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, table->NewPageGuarded(&page_id).GetData());
+  EXPECT_EQ(10, page_id);
+
+  // Scenario: the pages of an extent that were never created are deallocated with their allocator.
+  table.reset();
+  EXPECT_FALSE(disk_manager->IsPageAllocated(11));
+  EXPECT_TRUE(disk_manager->IsPageAllocated(10));
+  index.reset();
+  EXPECT_FALSE(disk_manager->IsPageAllocated(14));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(15));
+  EXPECT_TRUE(disk_manager->IsPageAllocated(16));
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, NewPageInExtentTest) {
+  const size_t buffer_pool_size = 2;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+  const page_id_t first_page_id = bpm->AllocateExtent(4);
+  ASSERT_EQ(0, first_page_id);
+
+  // Scenario: creating a page of the extent twice leaves the first one alone, pinned or not.
+  Page *page = bpm->NewPageInExtent(first_page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(nullptr, bpm->NewPageInExtent(first_page_id));
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(first_page_id, true));
+  EXPECT_EQ(nullptr, bpm->NewPageInExtent(first_page_id));
+  page = bpm->FetchPage(first_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, std::strcmp(page->GetData(), "Hello"));
+  EXPECT_TRUE(bpm->UnpinPage(first_page_id, false));
+
+  // Scenario: the other pages of the extent are still new.
+  ASSERT_NE(nullptr, bpm->NewPageInExtent(first_page_id + 1));
+  EXPECT_TRUE(bpm->UnpinPage(first_page_id + 1, false));
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, ParallelTest) {
+  const size_t num_instances = 3;
+  const size_t extent_size = 8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, 5, disk_manager.get());
+  ExtentAllocator allocator(bpm.get(), extent_size);
+
+  // Scenario: the pages of an extent are spread over the instances, and still contiguous.
+  page_id_t page_id;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(2 * extent_size); i++) {
+    auto guard = allocator.NewPageGuarded(&page_id);
+    ASSERT_NE(nullptr, guard.GetData());
+    EXPECT_EQ(i, page_id);
+    EXPECT_EQ(page_id, guard.PageId());
+  }
+}
+
+}  // namespace bustub
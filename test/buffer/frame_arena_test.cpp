@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 100;
+  const auto os_page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+  // Scenario: Frames are zeroed, aligned to OS pages, and laid out back to back.
+  auto arena = std::make_unique<FrameArena>(num_frames, false, -1);
+  EXPECT_FALSE(arena->UsesHugePages());
+  for (frame_id_t i = 0; i < static_cast<frame_id_t>(num_frames); i++) {
+    char *data = arena->GetFrameData(i);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % os_page_size);
+    EXPECT_EQ(arena->GetFrameData(0) + static_cast<size_t>(i) * BUSTUB_PAGE_SIZE, data);
+    for (size_t j = 0; j < BUSTUB_PAGE_SIZE; j += 512) {
+      EXPECT_EQ(0, data[j]);
+    }
+    data[BUSTUB_PAGE_SIZE - 1] = 1;
+  }
+
+  // Scenario: Asking for huge pages and a NUMA node always gives usable memory, whether or not the system has them.
+  arena = std::make_unique<FrameArena>(num_frames, true, 0);
+  for (frame_id_t i = 0; i < static_cast<frame_id_t>(num_frames); i++) {
+    char *data = arena->GetFrameData(i);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(data) % os_page_size);
+    data[0] = 1;
+    data[BUSTUB_PAGE_SIZE - 1] = 1;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 10;
+  const auto os_page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+
+  // Scenario: The pages of a buffer pool have their data in the arena, so it is aligned for O_DIRECT.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % os_page_size);
+  }
+
+  // Scenario: A page that is not part of a buffer pool still has data of its own.
+  Page page;
+  ASSERT_NE(nullptr, page.GetData());
+  EXPECT_EQ(0, page.GetData()[0]);
+}
+
+}  // namespace bustub
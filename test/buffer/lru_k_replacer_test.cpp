@@ -12,6 +12,7 @@
 #include <thread>  // NOLINT
 #include <vector>
 
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -97,4 +98,46 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, KDistanceTest) {
+  LRUKReplacer lru_replacer(4, 3);
+
+  // Scenario: Frames 0 and 1 are accessed three times, interleaved so that frame 1's third latest access is older
+  // although its latest access is more recent: 0 at t = 1, 2, 4 and 1 at t = 0, 3, 5.
+  for (frame_id_t frame_id : {1, 0, 0, 1, 0, 1}) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  // Frames 2 and 3 have fewer than three accesses, frame 3 was accessed first.
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(3);
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: Frames with +inf backward k-distance go first, oldest access first. Then the frame whose third latest
+  // access is the oldest, even though it was accessed last.
+  EXPECT_EQ((std::vector<frame_id_t>{3, 2, 1, 0}), lru_replacer.EvictionCandidates(4));
+  EXPECT_EQ((std::vector<frame_id_t>{3, 2}), lru_replacer.EvictionCandidates(2));
+  EXPECT_EQ(4, lru_replacer.Size());
+
+  // Scenario: Accessing an evictable frame moves it. Frame 1's third latest access is now t = 3, after frame 0's.
+  lru_replacer.RecordAccess(1);
+  EXPECT_EQ((std::vector<frame_id_t>{3, 2, 0, 1}), lru_replacer.EvictionCandidates(4));
+
+  // Scenario: Removed and evicted frames lose their history, and non-evictable frames are skipped.
+  lru_replacer.Remove(2);
+  lru_replacer.SetEvictable(3, false);
+  frame_id_t value;
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  lru_replacer.RecordAccess(0);
+  lru_replacer.SetEvictable(0, true);
+  EXPECT_EQ((std::vector<frame_id_t>{0, 1}), lru_replacer.EvictionCandidates(4));
+  EXPECT_EQ(2, lru_replacer.Size());
+
+  // Scenario: Out of range frame ids are rejected.
+  EXPECT_THROW(lru_replacer.RecordAccess(4), Exception);
+  EXPECT_THROW(lru_replacer.SetEvictable(-1, true), Exception);
+}
 }  // namespace bustub
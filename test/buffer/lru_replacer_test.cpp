@@ -15,48 +15,59 @@
 #include <vector>
 
 #include "buffer/lru_replacer.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(LRUReplacerTest, DISABLED_SampleTest) {
+TEST(LRUReplacerTest, SampleTest) {
   LRUReplacer lru_replacer(7);
 
-  // Scenario: unpin six elements, i.e. add them to the replacer.
-  lru_replacer.Unpin(1);
-  lru_replacer.Unpin(2);
-  lru_replacer.Unpin(3);
-  lru_replacer.Unpin(4);
-  lru_replacer.Unpin(5);
-  lru_replacer.Unpin(6);
-  lru_replacer.Unpin(1);
+  // Scenario: access six frames and unpin them, i.e. make them evictable. Then access frame 1 again.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_replacer.RecordAccess(frame_id);
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  lru_replacer.RecordAccess(1);
   EXPECT_EQ(6, lru_replacer.Size());
 
   // Scenario: get three victims from the lru.
   int value;
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(1, value);
-  lru_replacer.Victim(&value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
   EXPECT_EQ(2, value);
-  lru_replacer.Victim(&value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
   EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  EXPECT_EQ(4, value);
 
   // Scenario: pin elements in the replacer.
-  // Note that 3 has already been victimized, so pinning 3 should have no effect.
-  lru_replacer.Pin(3);
-  lru_replacer.Pin(4);
+  // Note that 3 has already been evicted, so pinning 3 should have no effect.
+  lru_replacer.SetEvictable(3, false);
+  lru_replacer.SetEvictable(5, false);
   EXPECT_EQ(2, lru_replacer.Size());
+  EXPECT_EQ(std::vector<frame_id_t>({6, 1}), lru_replacer.EvictionCandidates(5));
 
-  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
-  lru_replacer.Unpin(4);
+  // Scenario: access 5 and unpin it. It is the most recently used frame now.
+  lru_replacer.RecordAccess(5);
+  lru_replacer.SetEvictable(5, true);
 
   // Scenario: continue looking for victims. We expect these victims.
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(5, value);
-  lru_replacer.Victim(&value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
   EXPECT_EQ(6, value);
-  lru_replacer.Victim(&value);
-  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_replacer.Evict(&value));
+
+  // Scenario: a frame that is not evictable cannot be removed, and frame ids out of range throw.
+  lru_replacer.RecordAccess(2);
+  lru_replacer.Remove(2);
+  lru_replacer.SetEvictable(2, true);
+  EXPECT_EQ(1, lru_replacer.Size());
+  lru_replacer.Remove(2);
+  EXPECT_EQ(0, lru_replacer.Size());
+  EXPECT_THROW(lru_replacer.RecordAccess(7), Exception);
 }
 
 }  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  const size_t num_frames = 8;
+  auto table = std::make_unique<PageTable>(num_frames);
+  EXPECT_LE(2 * num_frames, table->GetCapacity());
+
+  // Scenario: Pages that were inserted can be found, others cannot.
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); page_id++) {
+    table->Insert(page_id, page_id + 100);
+  }
+  EXPECT_EQ(num_frames, table->Size());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); page_id++) {
+    ASSERT_TRUE(table->Find(page_id, frame_id));
+    EXPECT_EQ(page_id + 100, frame_id);
+  }
+  EXPECT_FALSE(table->Find(static_cast<page_id_t>(num_frames), frame_id));
+
+  // Scenario: Inserting a page again moves it to the new frame.
+  table->Insert(3, 7);
+  EXPECT_EQ(num_frames, table->Size());
+  ASSERT_TRUE(table->Find(3, frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  // Scenario: Removed pages are gone, and every other page can still be found.
+  EXPECT_TRUE(table->Remove(3));
+  EXPECT_FALSE(table->Remove(3));
+  EXPECT_FALSE(table->Find(3, frame_id));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); page_id++) {
+    EXPECT_EQ(page_id != 3, table->Find(page_id, frame_id));
+  }
+  EXPECT_EQ(num_frames - 1, table->Size());
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ChurnTest) {
+  const size_t num_frames = 64;
+  auto table = std::make_unique<PageTable>(num_frames);
+
+  // Scenario: Pages pass through the table the way they pass through a buffer pool. Removal must keep every probe
+  // sequence intact, so the resident pages are always found.
+  const page_id_t num_pages = 100000;
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    if (page_id >= static_cast<page_id_t>(num_frames)) {
+      // The oldest page goes, and hashing scatters it, so holes open up in the middle of clusters.
+      const page_id_t victim = page_id - static_cast<page_id_t>(num_frames);
+      ASSERT_TRUE(table->Remove(victim));
+    }
+    table->Insert(page_id, page_id % static_cast<page_id_t>(num_frames));
+    if (page_id % 97 == 0) {
+      for (page_id_t resident = std::max<page_id_t>(0, page_id - static_cast<page_id_t>(num_frames) + 1);
+           resident <= page_id; resident++) {
+        ASSERT_TRUE(table->Find(resident, frame_id));
+        EXPECT_EQ(resident % static_cast<page_id_t>(num_frames), frame_id);
+      }
+    }
+  }
+  EXPECT_EQ(num_frames, table->Size());
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t num_frames = 128;
+  const int num_readers = 4;
+  auto table = std::make_unique<PageTable>(num_frames);
+
+  // Scenario: Half of the frames hold pages that never move, the other half see constant churn by a writer.
+  const auto num_stable = static_cast<page_id_t>(num_frames / 2);
+  for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+    table->Insert(page_id, page_id);
+  }
+
+  // Scenario: Readers always find the stable pages in their frames, no matter what the writer does.
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&table, &stop, num_stable]() {
+      frame_id_t frame_id;
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+          ASSERT_TRUE(table->Find(page_id, frame_id));
+          ASSERT_EQ(page_id, frame_id);
+        }
+      }
+    });
+  }
+
+  for (page_id_t page_id = num_stable; page_id < 200000; page_id++) {
+    if (page_id >= 2 * num_stable) {
+      table->Remove(page_id - num_stable);
+    }
+    table->Insert(page_id, page_id % num_stable + num_stable);
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
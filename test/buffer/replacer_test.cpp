@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_test.cpp
+//
+// Identification: test/buffer/replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/replacer.h"
+
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Replay page accesses against a replacer the way the buffer pool drives it: every access pins and unpins the page, and
+ * a miss takes a free frame or evicts one.
+ */
+auto ReplayHitRatio(ReplacerPolicy policy, size_t num_frames, const std::vector<page_id_t> &accesses) -> double {
+  std::unique_ptr<Replacer> replacer(CreateReplacer(policy, num_frames, 2));
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_pages(num_frames, INVALID_PAGE_ID);
+  size_t num_used_frames = 0;
+  size_t hits = 0;
+  for (auto page_id : accesses) {
+    auto it = page_table.find(page_id);
+    frame_id_t frame_id;
+    if (it != page_table.end()) {
+      hits++;
+      frame_id = it->second;
+    } else {
+      if (num_used_frames < num_frames) {
+        frame_id = static_cast<frame_id_t>(num_used_frames++);
+      } else {
+        EXPECT_TRUE(replacer->Evict(&frame_id));
+        page_table.erase(frame_pages[frame_id]);
+      }
+      frame_pages[frame_id] = page_id;
+      page_table[page_id] = frame_id;
+      replacer->SetPageId(frame_id, page_id);
+    }
+    replacer->RecordAccess(frame_id);
+    replacer->SetEvictable(frame_id, false);
+    replacer->SetEvictable(frame_id, true);
+  }
+  return static_cast<double>(hits) / static_cast<double>(accesses.size());
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(ReplacerTest, PolicyNameTest) {
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::LRU_K, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TWO_Q}) {
+    ReplacerPolicy parsed;
+    ASSERT_TRUE(ParseReplacerPolicy(ReplacerPolicyToString(policy), &parsed));
+    EXPECT_EQ(policy, parsed);
+  }
+  ReplacerPolicy parsed;
+  ASSERT_TRUE(ParseReplacerPolicy("ARC", &parsed));
+  EXPECT_EQ(ReplacerPolicy::ARC, parsed);
+  EXPECT_FALSE(ParseReplacerPolicy("mru", &parsed));
+}
+
+// NOLINTNEXTLINE
+TEST(ReplacerTest, ScanResistanceTest) {
+  // Scenario: a hot set of 24 pages that is read twice in a row, followed by a scan over 48 pages that are never read
+  // again. LRU and CLOCK let every scan flush the hot set, so only the second read of each round hits. The other
+  // policies see that the hot pages were accessed twice and the scanned pages once, and keep the hot set.
+  const size_t num_frames = 64;
+  std::vector<page_id_t> accesses;
+  page_id_t next_scan_page = 1000;
+  for (int round = 0; round < 50; round++) {
+    for (int pass = 0; pass < 2; pass++) {
+      for (page_id_t page_id = 0; page_id < 24; page_id++) {
+        accesses.push_back(page_id);
+      }
+    }
+    for (int i = 0; i < 48; i++) {
+      accesses.push_back(next_scan_page++);
+    }
+  }
+
+  std::unordered_map<ReplacerPolicy, double> hit_ratios;
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK, ReplacerPolicy::LRU_K, ReplacerPolicy::ARC,
+                      ReplacerPolicy::TWO_Q}) {
+    hit_ratios[policy] = ReplayHitRatio(policy, num_frames, accesses);
+    printf("%-6s hit ratio %.3f\n", ReplacerPolicyToString(policy).c_str(), hit_ratios[policy]);
+  }
+  EXPECT_LE(hit_ratios[ReplacerPolicy::LRU], 0.25);
+  EXPECT_LE(hit_ratios[ReplacerPolicy::CLOCK], 0.25);
+  for (auto policy : {ReplacerPolicy::LRU_K, ReplacerPolicy::ARC, ReplacerPolicy::TWO_Q}) {
+    EXPECT_GT(hit_ratios[policy], 0.45) << ReplacerPolicyToString(policy);
+  }
+}
+
+}  // namespace bustub
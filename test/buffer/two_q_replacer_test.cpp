@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer_test.cpp
+//
+// Identification: test/buffer/two_q_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Load a page into a frame and unpin it, like the buffer pool does on a miss. */
+void LoadPage(TwoQReplacer *replacer, frame_id_t frame_id, page_id_t page_id) {
+  replacer->SetPageId(frame_id, page_id);
+  replacer->RecordAccess(frame_id);
+  replacer->SetEvictable(frame_id, true);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(TwoQReplacerTest, SampleTest) {
+  TwoQReplacer two_q_replacer(8);
+
+  // Scenario: load pages 0 to 7 into frames 0 to 7. The cache size is 8, so Kin = 2 and Kout = 4.
+  for (frame_id_t frame_id = 0; frame_id < 8; frame_id++) {
+    LoadPage(&two_q_replacer, frame_id, frame_id);
+  }
+  ASSERT_EQ(8, two_q_replacer.Size());
+
+  // Scenario: another access to a page in A1in does not move it, A1in is a FIFO queue.
+  two_q_replacer.RecordAccess(0);
+  frame_id_t frame_id;
+  ASSERT_TRUE(two_q_replacer.Evict(&frame_id));
+  ASSERT_EQ(0, frame_id);
+  ASSERT_TRUE(two_q_replacer.Evict(&frame_id));
+  ASSERT_EQ(1, frame_id);
+
+  // Scenario: pages 0 and 1 come back while they are in A1out, so they go into Am. A1in is evicted down to Kin frames
+  // first, then Am in LRU order, then the rest of A1in.
+  LoadPage(&two_q_replacer, 0, 0);
+  LoadPage(&two_q_replacer, 1, 1);
+  ASSERT_EQ(std::vector<frame_id_t>({2, 3, 4, 5, 0, 1, 6, 7}), two_q_replacer.EvictionCandidates(8));
+
+  // Scenario: a pinned frame is skipped.
+  two_q_replacer.SetEvictable(2, false);
+  ASSERT_TRUE(two_q_replacer.Evict(&frame_id));
+  ASSERT_EQ(3, frame_id);
+  two_q_replacer.SetEvictable(2, true);
+
+  // Scenario: evict everything. A1out only remembers the last Kout pages evicted from A1in: [4, 5, 6, 7].
+  while (two_q_replacer.Evict(&frame_id)) {
+  }
+  ASSERT_EQ(0, two_q_replacer.Size());
+
+  // Scenario: page 3 was forgotten and goes into A1in, page 4 is still in A1out and goes into Am.
+  LoadPage(&two_q_replacer, 2, 3);
+  LoadPage(&two_q_replacer, 3, 4);
+  ASSERT_EQ(std::vector<frame_id_t>({3, 2}), two_q_replacer.EvictionCandidates(8));
+
+  EXPECT_THROW(two_q_replacer.RecordAccess(8), Exception);
+}
+
+}  // namespace bustub
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValueTest) {
+  // Scenario: the check value of CRC-32C, and the test vectors of RFC 3720, section B.4.
+  const std::string check("123456789");
+  EXPECT_EQ(0xE3069283, Crc32c::Compute(check.data(), check.size()));
+  EXPECT_EQ(0xE3069283, Crc32c::ComputeSoftware(check.data(), check.size()));
+
+  std::vector<char> bytes(32, 0);
+  EXPECT_EQ(0x8A9136AA, Crc32c::Compute(bytes.data(), bytes.size()));
+  bytes.assign(32, static_cast<char>(0xFF));
+  EXPECT_EQ(0x62A8AB43, Crc32c::Compute(bytes.data(), bytes.size()));
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<char>(i);
+  }
+  EXPECT_EQ(0x46DD794E, Crc32c::Compute(bytes.data(), bytes.size()));
+
+  EXPECT_EQ(0, Crc32c::Compute(nullptr, 0));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, HardwareMatchesSoftwareTest) {
+  std::mt19937 generator(15445);
+  std::vector<char> bytes(10000);
+  for (auto &byte : bytes) {
+    byte = static_cast<char>(generator());
+  }
+
+  // Scenario: every length and alignment, including the bytes left over after the eight byte words.
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t length = 0; offset + length <= 100; length++) {
+      ASSERT_EQ(Crc32c::ComputeSoftware(bytes.data() + offset, length), Crc32c::Compute(bytes.data() + offset, length));
+    }
+  }
+
+  // Scenario: lengths around the blocks that are checksummed three at a time.
+  for (size_t length : {767, 768, 769, 3071, 3072, 3073, 4096, 4097, 10000}) {
+    ASSERT_EQ(Crc32c::ComputeSoftware(bytes.data(), length), Crc32c::Compute(bytes.data(), length));
+  }
+
+  // Scenario: a buffer checksummed in pieces has the checksum of the whole buffer.
+  const uint32_t whole = Crc32c::Compute(bytes.data(), bytes.size());
+  EXPECT_EQ(whole, Crc32c::Compute(bytes.data() + 333, bytes.size() - 333, Crc32c::Compute(bytes.data(), 333)));
+  EXPECT_EQ(whole, Crc32c::ComputeSoftware(bytes.data() + 7, bytes.size() - 7, Crc32c::Compute(bytes.data(), 7)));
+}
+
+}  // namespace bustub
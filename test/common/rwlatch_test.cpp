@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <cstdint>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -57,4 +59,65 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, OptimisticReadTest) {
+  ReaderWriterLatch latch{};
+  uint64_t version;
+
+  // Scenario: An optimistic read fails to start while a writer holds the latch, and fails to validate if a writer came
+  // and went in the meantime.
+  latch.WLock();
+  EXPECT_FALSE(latch.TryOptimisticRead(&version));
+  latch.WUnlock();
+  ASSERT_TRUE(latch.TryOptimisticRead(&version));
+  EXPECT_TRUE(latch.ValidateOptimisticRead(version));
+  latch.RLock();
+  latch.RUnlock();
+  EXPECT_TRUE(latch.ValidateOptimisticRead(version));
+  latch.WLock();
+  latch.WUnlock();
+  EXPECT_FALSE(latch.ValidateOptimisticRead(version));
+
+  // Scenario: Writers keep two values equal. Optimistic readers may see them differ, but never validate such a read.
+  // The values are atomics only so that the torn reads are not data races.
+  std::atomic<int> first{0};
+  std::atomic<int> second{0};
+  std::atomic<int> num_validated{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; tid++) {
+    if (tid % 2 == 0) {
+      threads.emplace_back([&]() {
+        for (int i = 0; i < 10000; i++) {
+          latch.WLock();
+          first.store(first.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          second.store(second.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          latch.WUnlock();
+        }
+      });
+    } else {
+      // Keep reading until some read validated, since a reader may only ever get scheduled while a writer is active.
+      threads.emplace_back([&]() {
+        for (int i = 0; i < 10000 || num_validated == 0; i++) {
+          uint64_t read_version;
+          if (!latch.TryOptimisticRead(&read_version)) {
+            continue;
+          }
+          const int first_value = first.load(std::memory_order_relaxed);
+          const int second_value = second.load(std::memory_order_relaxed);
+          if (latch.ValidateOptimisticRead(read_version)) {
+            EXPECT_EQ(first_value, second_value);
+            num_validated++;
+          }
+        }
+      });
+    }
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(20000, first);
+  EXPECT_EQ(20000, second);
+  EXPECT_LT(0, num_validated);
+}
 }  // namespace bustub
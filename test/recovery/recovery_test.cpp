@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/bustub_instance.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -257,14 +258,19 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   bustub_instance->checkpoint_manager_->BeginCheckpoint();
   bustub_instance->checkpoint_manager_->EndCheckpoint();
 
-  // Hacky
-  Page *pages = dynamic_cast<BufferPoolManagerInstance *>(bustub_instance->buffer_pool_manager_)->GetPages();
-  size_t pool_size = bustub_instance->buffer_pool_manager_->GetPoolSize();
+  // Hacky: collect the frames of every buffer pool instance.
+  auto *parallel_bpm = dynamic_cast<ParallelBufferPoolManager *>(bustub_instance->buffer_pool_manager_);
+  std::vector<Page *> frames;
+  for (size_t i = 0; i < parallel_bpm->GetNumInstances(); i++) {
+    BufferPoolManagerInstance *instance = parallel_bpm->GetInstance(i);
+    for (size_t j = 0; j < instance->GetPoolSize(); j++) {
+      frames.push_back(&instance->GetPages()[j]);
+    }
+  }
 
   // make sure that all pages in the buffer pool are marked as non-dirty
   bool all_pages_clean = true;
-  for (size_t i = 0; i < pool_size; i++) {
-    Page *page = &pages[i];
+  for (Page *page : frames) {
     page_id_t page_id = page->GetPageId();
 
     if (page_id != INVALID_PAGE_ID && page->IsDirty()) {
@@ -278,8 +284,7 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   // data on disk. ensure they match after the checkpoint
   bool all_pages_match = true;
   auto *disk_data = new char[BUSTUB_PAGE_SIZE];
-  for (size_t i = 0; i < pool_size; i++) {
-    Page *page = &pages[i];
+  for (Page *page : frames) {
     page_id_t page_id = page->GetPageId();
 
     if (page_id != INVALID_PAGE_ID) {
@@ -301,8 +306,7 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
 
   // verify log was flushed and each page's LSN <= persistent lsn
   bool all_pages_lte = true;
-  for (size_t i = 0; i < pool_size; i++) {
-    Page *page = &pages[i];
+  for (Page *page : frames) {
     page_id_t page_id = page->GetPageId();
 
     if (page_id != INVALID_PAGE_ID && page->GetLSN() > persistent_lsn) {
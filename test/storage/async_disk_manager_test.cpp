@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+/** Runs every test with io_uring, and with the thread pool that AsyncDiskManager falls back to. */
+class AsyncDiskManagerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ReadWritePageTest) {
+  const size_t num_pages = 4 * ASYNC_IO_QUEUE_DEPTH;
+  AsyncDiskManager dm("test.db", GetParam());
+
+  // Scenario: a page past the end of the file reads as zeroes.
+  char buf[BUSTUB_PAGE_SIZE];
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPageAsync(3, buf).get();
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(buf, BUSTUB_PAGE_SIZE));
+
+  // Scenario: write more pages than fit in the queue at once, then read them all back at once.
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::future<void>> futures;
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page %zu", i);
+    futures.push_back(dm.WritePageAsync(static_cast<page_id_t>(i), pages[i].data()));
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  std::vector<std::vector<char>> read_pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  futures.clear();
+  for (size_t i = 0; i < num_pages; i++) {
+    futures.push_back(dm.ReadPageAsync(static_cast<page_id_t>(i), read_pages[i].data()));
+  }
+  for (size_t i = 0; i < num_pages; i++) {
+    futures[i].get();
+    EXPECT_EQ(pages[i], read_pages[i]);
+  }
+
+  // Scenario: the synchronous calls see the same file.
+  dm.ReadPage(7, buf);
+  EXPECT_EQ(0, std::memcmp(buf, pages[7].data(), BUSTUB_PAGE_SIZE));
+  dm.WritePage(7, pages[8].data());
+  dm.ReadPageAsync(7, buf).get();
+  EXPECT_EQ(0, std::memcmp(buf, pages[8].data(), BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ConcurrentIoTest) {
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 64;
+  AsyncDiskManager dm("test.db", GetParam());
+
+  // Scenario: every thread writes and reads back its own pages while the others do the same, with a few requests of
+  // its own in flight at any time.
+  std::vector<std::thread> threads;
+  std::vector<int> ok(num_threads, 1);
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      std::vector<std::vector<char>> pages(pages_per_thread, std::vector<char>(BUSTUB_PAGE_SIZE));
+      std::vector<std::future<void>> futures;
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "thread %zu page %zu", tid, i);
+        futures.push_back(dm.WritePageAsync(static_cast<page_id_t>(i * num_threads + tid), pages[i].data()));
+      }
+      for (auto &future : futures) {
+        future.get();
+      }
+      std::vector<char> buf(BUSTUB_PAGE_SIZE);
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        dm.ReadPageAsync(static_cast<page_id_t>(i * num_threads + tid), buf.data()).get();
+        if (buf != pages[i]) {
+          ok[tid] = 0;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    EXPECT_EQ(1, ok[tid]);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+  AsyncDiskManager dm("test.db", GetParam());
+  BufferPoolManagerInstance bpm(buffer_pool_size, &dm, 2);
+
+  // Scenario: create more dirty pages than fit into the buffer pool, so that most of them are written back.
+  page_id_t page_id;
+  for (size_t i = 0; i < num_pages; i++) {
+    Page *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id);
+    ASSERT_TRUE(bpm.UnpinPage(page_id, true));
+  }
+
+  // Scenario: fetch them back in batches, whose write backs and reads are in flight together.
+  for (size_t start = 0; start < num_pages; start += buffer_pool_size) {
+    std::vector<page_id_t> page_ids;
+    for (size_t i = start; i < start + buffer_pool_size; i++) {
+      page_ids.push_back(static_cast<page_id_t>(i));
+    }
+    auto pages = bpm.FetchPages(page_ids);
+    for (size_t i = 0; i < pages.size(); i++) {
+      ASSERT_NE(nullptr, pages[i]);
+      EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+      ASSERT_TRUE(bpm.UnpinPage(page_ids[i], false));
+    }
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ChecksumTest) {
+  AsyncDiskManager dm("test.db", GetParam());
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  dm.WritePageAsync(0, data).get();
+  dm.WritePageAsync(1, data).get();
+
+  // Scenario: the future of a read of a corrupt page holds the error, the future of an intact page does not.
+  FILE *file = fopen("test.db", "r+b");
+  ASSERT_NE(nullptr, file);
+  fseek(file, 10, SEEK_SET);
+  fputc('!', file);
+  fclose(file);
+  auto corrupt_read = dm.ReadPageAsync(0, buf);
+  EXPECT_THROW(corrupt_read.get(), Exception);
+  dm.ReadPageAsync(1, buf).get();
+  EXPECT_EQ(std::string("A test string."), std::string(buf));
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+
+  dm.ShutDown();
+}
+
+INSTANTIATE_TEST_SUITE_P(AsyncDiskManagerTest, AsyncDiskManagerTest, ::testing::Bool());
+
+}  // namespace bustub
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap_test.cpp
+//
+// Identification: test/storage/disk_manager_mmap_test.cpp
+//
+// Copyright (c) 2015-2020, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
+
+namespace bustub {
+
+class DiskManagerMmapTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
+
+    // Write the snapshot that the tests map.
+    DiskManager dm("test.db");
+    char data[BUSTUB_PAGE_SIZE] = {0};
+    for (page_id_t page_id = 0; page_id < NUM_PAGES; page_id++) {
+      snprintf(data, sizeof(data), "page %d", page_id);
+      dm.WritePage(page_id, data);
+    }
+    dm.ShutDown();
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
+  };
+
+  static constexpr page_id_t NUM_PAGES = 16;
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerMmapTest, ReadPageTest) {
+  DiskManagerMmap dm("test.db", MmapAccessPattern::RANDOM);
+  EXPECT_EQ(NUM_PAGES, dm.GetNumPages());
+
+  // Scenario: pages are copied out of the mapping, or read in place.
+  char buf[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < NUM_PAGES; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(buf));
+    ASSERT_NE(nullptr, dm.GetPageData(page_id));
+    EXPECT_EQ(0, std::memcmp(buf, dm.GetPageData(page_id), BUSTUB_PAGE_SIZE));
+  }
+
+  // Scenario: hints are harmless, also for ranges that reach past the end of the file.
+  dm.SetAccessPattern(MmapAccessPattern::SEQUENTIAL);
+  dm.WillNeed(NUM_PAGES / 2, NUM_PAGES);
+  dm.WillNeed(NUM_PAGES, 1);
+
+  // Scenario: pages past the end of the file read as zeroes, and have no data to point to.
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(NUM_PAGES, buf);
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(buf, BUSTUB_PAGE_SIZE));
+  EXPECT_EQ(nullptr, dm.GetPageData(NUM_PAGES));
+  EXPECT_EQ(nullptr, dm.GetPageData(INVALID_PAGE_ID));
+
+  // Scenario: the file is read-only.
+  EXPECT_THROW(dm.WritePage(0, buf), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerMmapTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 4;
+  DiskManagerMmap dm("test.db");
+  BufferPoolManagerInstance bpm(buffer_pool_size, &dm, 2);
+
+  // Scenario: a buffer pool reads the snapshot through the mapping, evicting clean pages as it goes.
+  for (int round = 0; round < 2; round++) {
+    for (page_id_t page_id = 0; page_id < NUM_PAGES; page_id++) {
+      Page *page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+      ASSERT_TRUE(bpm.UnpinPage(page_id, false));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerMmapTest, DirtyPageTest) {
+  const size_t buffer_pool_size = 1;
+  DiskManagerMmap dm("test.db");
+  BufferPoolManagerInstance bpm(buffer_pool_size, &dm, 2);
+
+  Page *page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "changed");
+  ASSERT_TRUE(bpm.UnpinPage(0, true));
+
+  // Scenario: a dirty page can't be evicted, since it can't be written back. It stays resident with its changes, and
+  // the pages that would take its frame can't be fetched, again and again, in one go or many.
+  for (int round = 0; round < 2; round++) {
+    EXPECT_EQ(nullptr, bpm.FetchPage(1));
+    EXPECT_EQ(std::vector<Page *>({nullptr, nullptr}), bpm.FetchPages({1, 2}));
+    page = bpm.FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("changed", std::string(page->GetData()));
+    ASSERT_TRUE(bpm.UnpinPage(0, false));
+  }
+
+  // Scenario: flushing the page fails, and leaves it dirty, so it still can't be evicted.
+  EXPECT_FALSE(bpm.FlushPage(0));
+  bpm.FlushAllPages();
+  EXPECT_EQ(nullptr, bpm.FetchPage(1));
+
+  // Scenario: once the page and its changes are dropped, its frame can be reused.
+  ASSERT_TRUE(bpm.DeletePage(0));
+  page = bpm.FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 1", std::string(page->GetData()));
+  ASSERT_TRUE(bpm.UnpinPage(1, false));
+
+  // Scenario: shrinking fails without any change if it would have to evict a dirty page.
+  BufferPoolManagerInstance resizable_bpm(2, &dm, 2, nullptr, 2);
+  ASSERT_NE(nullptr, resizable_bpm.FetchPage(0));
+  page = resizable_bpm.FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "changed");
+  ASSERT_TRUE(resizable_bpm.UnpinPage(0, false));
+  ASSERT_TRUE(resizable_bpm.UnpinPage(1, true));
+  EXPECT_FALSE(resizable_bpm.Resize(1));
+  EXPECT_EQ(2, resizable_bpm.GetPoolSize());
+  page = resizable_bpm.FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("changed", std::string(page->GetData()));
+  ASSERT_TRUE(resizable_bpm.UnpinPage(1, false));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerMmapTest, MissingFileTest) { EXPECT_THROW(DiskManagerMmap("missing.db"), Exception); }
+
+}  // namespace bustub
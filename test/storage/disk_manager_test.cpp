@@ -10,7 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +31,16 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
   };
 };
 
@@ -53,6 +64,285 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
 
   dm.ShutDown();
+
+  // Scenario: a write that fails throws, instead of losing the page silently.
+  try {
+    dm.WritePage(0, data);
+    FAIL() << "a failed write went unnoticed";
+  } catch (const Exception &e) {
+    EXPECT_EQ(ExceptionType::IO_ERROR, e.GetType());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 64;
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+
+  // Scenario: every thread writes and reads back its own pages, interleaved with the pages of the other threads, all
+  // at the same time.
+  std::vector<std::thread> threads;
+  std::vector<int> mismatches(num_threads, 0);
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      char data[BUSTUB_PAGE_SIZE] = {0};
+      char buf[BUSTUB_PAGE_SIZE] = {0};
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        auto page_id = static_cast<page_id_t>(i * num_threads + tid);
+        snprintf(data, sizeof(data), "page %d", page_id);
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        if (std::memcmp(buf, data, sizeof(buf)) != 0) {
+          mismatches[tid]++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    EXPECT_EQ(0, mismatches[tid]);
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  // Scenario: a page past the end of the file reads as zeroes.
+  char buf[BUSTUB_PAGE_SIZE];
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(static_cast<page_id_t>(num_threads * pages_per_thread), buf);
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(buf, BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  std::string db_file("test.db");
+  DiskManager dm(db_file, true);
+  if (!dm.UsesDirectIO()) {
+    GTEST_SKIP() << "the file system does not support O_DIRECT";
+  }
+
+  // Scenario: pages go through aligned buffers as they are, and through a bounce buffer if they are not aligned.
+  alignas(DIRECT_IO_ALIGNMENT) char aligned[BUSTUB_PAGE_SIZE] = {0};
+  alignas(DIRECT_IO_ALIGNMENT) char unaligned_storage[BUSTUB_PAGE_SIZE + 1] = {0};
+  char *unaligned = unaligned_storage + 1;
+  std::strncpy(aligned, "An aligned page.", sizeof(aligned));
+  std::strncpy(unaligned, "An unaligned page.", BUSTUB_PAGE_SIZE);
+
+  dm.WritePage(0, aligned);
+  dm.WritePage(1, unaligned);
+  char buf[BUSTUB_PAGE_SIZE];
+  dm.ReadPage(0, unaligned);
+  EXPECT_EQ(std::string("An aligned page."), std::string(unaligned));
+  dm.ReadPage(1, aligned);
+  EXPECT_EQ(std::string("An unaligned page."), std::string(aligned));
+
+  // Scenario: a page past the end of the file reads as zeroes.
+  std::memset(buf, 'x', sizeof(buf));
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(std::string(BUSTUB_PAGE_SIZE, '\0'), std::string(buf, BUSTUB_PAGE_SIZE));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  ASSERT_TRUE(dm.UsesChecksums());
+  // Fill the pages, so that losing any part of them changes their contents.
+  memset(data, 'x', sizeof(data));
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+
+  // Scenario: a bit flips on disk. The other pages still read fine.
+  FILE *file = fopen(db_file.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  fseek(file, BUSTUB_PAGE_SIZE + 100, SEEK_SET);
+  fputc(1, file);
+  fclose(file);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::string("page 0"), std::string(buf));
+  try {
+    dm.ReadPage(1, buf);
+    FAIL() << "a corrupt page was read";
+  } catch (const Exception &e) {
+    EXPECT_EQ(ExceptionType::DATA_CORRUPTION, e.GetType());
+  }
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+
+  // Scenario: writing the page again repairs it.
+  snprintf(data, sizeof(data), "page %d", 1);
+  dm.WritePage(1, data);
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(std::string("page 1"), std::string(buf));
+
+  // Scenario: a write of the last page is torn, only its first half made it to disk.
+  ASSERT_EQ(0, truncate(db_file.c_str(), 2 * BUSTUB_PAGE_SIZE + BUSTUB_PAGE_SIZE / 2));
+  EXPECT_THROW(dm.ReadPage(2, buf), Exception);
+  EXPECT_EQ(2, dm.GetNumChecksumFailures());
+  dm.ShutDown();
+
+  // Scenario: without checksums, corruption goes unnoticed.
+  enable_page_checksums = false;
+  DiskManager unchecked_dm(db_file);
+  enable_page_checksums = true;
+  EXPECT_FALSE(unchecked_dm.UsesChecksums());
+  unchecked_dm.ReadPage(2, buf);
+  EXPECT_EQ(std::string("page 2"), std::string(buf));
+  EXPECT_EQ(0, unchecked_dm.GetNumChecksumFailures());
+  unchecked_dm.ShutDown();
+
+  // Scenario: reading without checksums keeps them, they still catch the corruption.
+  DiskManager rechecked_dm(db_file);
+  EXPECT_THROW(rechecked_dm.ReadPage(2, buf), Exception);
+  rechecked_dm.ShutDown();
+
+  // Scenario: writing without checksums makes them stale, the pages then go unverified until they are written again.
+  enable_page_checksums = false;
+  DiskManager writing_dm(db_file);
+  enable_page_checksums = true;
+  snprintf(data, sizeof(data), "page %d changed", 0);
+  writing_dm.WritePage(0, data);
+  writing_dm.ShutDown();
+  DiskManager stale_dm(db_file);
+  stale_dm.ReadPage(0, buf);
+  EXPECT_EQ(std::string("page 0 changed"), std::string(buf));
+  stale_dm.ReadPage(2, buf);
+  EXPECT_EQ(0, stale_dm.GetNumChecksumFailures());
+  stale_dm.WritePage(0, data);
+  ASSERT_EQ(0, truncate(db_file.c_str(), BUSTUB_PAGE_SIZE / 2));
+  EXPECT_THROW(stale_dm.ReadPage(0, buf), Exception);
+  stale_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChangingPageChecksumTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  DiskManager dm("test.db");
+  ASSERT_TRUE(dm.UsesChecksums());
+
+  // Scenario: a page that changes while it is written, like a frame that is flushed without its latch, gets the
+  // checksum of the bytes that reached the disk.
+  std::atomic<bool> stop{false};
+  std::thread changer([&] {
+    for (char c = 0; !stop; c++) {
+      memset(data, c, sizeof(data));
+    }
+  });
+  for (int i = 0; i < 1000; i++) {
+    dm.WritePage(0, data);
+    EXPECT_NO_THROW(dm.ReadPage(0, buf));
+  }
+  stop = true;
+  changer.join();
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  for (page_id_t page_id = 0; page_id < 5; page_id++) {
+    EXPECT_EQ(page_id, dm.AllocatePage());
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.WritePage(page_id, data);
+  }
+
+  // Scenario: deallocated pages are reused lowest first, before the file grows. They read as zeroes.
+  dm.DeallocatePage(3);
+  dm.DeallocatePage(1);
+  dm.DeallocatePage(1);
+  EXPECT_FALSE(dm.IsPageAllocated(1));
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(std::string(), std::string(buf));
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+  EXPECT_EQ(1, dm.AllocatePage());
+  EXPECT_EQ(3, dm.AllocatePage());
+  EXPECT_EQ(5, dm.AllocatePage());
+
+  // Scenario: stripes only get their own pages. The pages skipped by one are left to the others.
+  EXPECT_EQ(7, dm.AllocatePage(4, 3));
+  EXPECT_EQ(6, dm.AllocatePage(2, 0));
+  EXPECT_EQ(9, dm.AllocatePage(2, 1));
+  EXPECT_EQ(8, dm.AllocatePage());
+  dm.DeallocatePage(2);
+  dm.DeallocatePage(9);
+  dm.ShutDown();
+
+  // Scenario: the allocated pages survive a restart, with their data.
+  DiskManager reopened_dm(db_file);
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    EXPECT_EQ(page_id != 2 && page_id != 9, reopened_dm.IsPageAllocated(page_id));
+  }
+  reopened_dm.ReadPage(4, buf);
+  EXPECT_EQ(std::string("page 4"), std::string(buf));
+  EXPECT_EQ(2, reopened_dm.AllocatePage());
+  EXPECT_EQ(9, reopened_dm.AllocatePage());
+  EXPECT_EQ(10, reopened_dm.AllocatePage());
+
+  // Scenario: the stripes keep up with the pages that extents and deallocations take and free.
+  EXPECT_EQ(13, reopened_dm.AllocatePage(4, 1));
+  EXPECT_EQ(11, reopened_dm.AllocateExtent(2));
+  reopened_dm.DeallocatePage(5);
+  EXPECT_EQ(5, reopened_dm.AllocatePage(4, 1));
+  EXPECT_EQ(16, reopened_dm.AllocatePage(4, 0));
+  EXPECT_EQ(14, reopened_dm.AllocatePage());
+  reopened_dm.ShutDown();
+
+  // Scenario: without a bitmap, every page of the database file counts as allocated.
+  remove("test.fsm");
+  DiskManager upgraded_dm(db_file);
+  for (page_id_t page_id = 0; page_id < 5; page_id++) {
+    EXPECT_TRUE(upgraded_dm.IsPageAllocated(page_id));
+  }
+  EXPECT_EQ(5, upgraded_dm.AllocatePage());
+  upgraded_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocateExtentTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+
+  // Scenario: extents are contiguous, and single pages are allocated around them.
+  EXPECT_EQ(0, dm.AllocateExtent(4));
+  EXPECT_EQ(4, dm.AllocatePage());
+  EXPECT_EQ(5, dm.AllocateExtent(4));
+  for (page_id_t page_id = 0; page_id < 9; page_id++) {
+    EXPECT_TRUE(dm.IsPageAllocated(page_id));
+  }
+
+  // Scenario: an extent reuses the first run of free pages that is long enough. Shorter runs are skipped.
+  dm.DeallocatePage(1);
+  dm.DeallocatePage(2);
+  for (page_id_t page_id = 5; page_id < 8; page_id++) {
+    dm.DeallocatePage(page_id);
+  }
+  EXPECT_EQ(5, dm.AllocateExtent(3));
+  EXPECT_EQ(9, dm.AllocateExtent(3));
+  EXPECT_EQ(1, dm.AllocatePage());
+  // An empty database file is opened with an empty bitmap, so write a page.
+  dm.WritePage(0, data);
+  dm.ShutDown();
+
+  // Scenario: the extents survive a restart.
+  DiskManager reopened_dm(db_file);
+  EXPECT_EQ(2, reopened_dm.AllocatePage());
+  EXPECT_EQ(12, reopened_dm.AllocatePage());
+  reopened_dm.ShutDown();
 }
 
 // NOLINTNEXTLINE
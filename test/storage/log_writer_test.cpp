@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_writer_test.cpp
+//
+// Identification: test/storage/log_writer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/log_writer.h"
+
+namespace bustub {
+
+class LogWriterTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
+  };
+};
+
+/** A fixed-size record that names its writer and sequence number. */
+static auto MakeRecord(size_t writer, size_t seq) -> std::string {
+  char record[32] = {0};
+  snprintf(record, sizeof(record), "writer %03zu record %05zu", writer, seq);
+  return std::string(record, sizeof(record));
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogWriterTest, CommitTest) {
+  DiskManager dm("test.db");
+  auto log_writer = std::make_unique<LogWriter>(&dm);
+  EXPECT_EQ(INVALID_LSN, log_writer->GetDurableLSN());
+
+  // Scenario: commits get consecutive LSNs, and are durable when Commit() returns.
+  std::string expected;
+  for (size_t i = 0; i < 3; i++) {
+    auto record = MakeRecord(0, i);
+    EXPECT_EQ(static_cast<lsn_t>(i), log_writer->Commit(record.data(), record.size()));
+    expected += record;
+  }
+  EXPECT_EQ(2, log_writer->GetDurableLSN());
+  EXPECT_EQ(3, log_writer->GetNumSyncs());
+
+  // Scenario: records that nobody waits for are written out when the writer is destroyed.
+  auto record = MakeRecord(0, 3);
+  EXPECT_EQ(3, log_writer->Append(record.data(), record.size()));
+  expected += record;
+  log_writer.reset();
+
+  std::vector<char> buf(expected.size() + 1);
+  ASSERT_TRUE(dm.ReadLog(buf.data(), static_cast<int>(buf.size()), 0));
+  EXPECT_EQ(expected, std::string(buf.data(), expected.size()));
+  EXPECT_EQ('\0', buf.back());
+  EXPECT_FALSE(dm.ReadLog(buf.data(), static_cast<int>(buf.size()), static_cast<int>(expected.size())));
+
+  // Scenario: a record that does not fit into the log buffer is refused.
+  LogWriter small_log_writer(&dm, 16);
+  EXPECT_THROW(small_log_writer.Append(record.data(), record.size()), Exception);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogWriterTest, GroupCommitTest) {
+  const size_t num_threads = 8;
+  const size_t commits_per_thread = 50;
+  DiskManager dm("test.db");
+  // Small buffers, so that appenders also have to wait for room.
+  auto log_writer = std::make_unique<LogWriter>(&dm, 256);
+
+  // Scenario: many threads commit concurrently. Each commit is durable when it returns, and commits that arrive during
+  // a sync share the next one.
+  std::vector<std::thread> threads;
+  std::vector<int> not_durable(num_threads, 0);
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      for (size_t i = 0; i < commits_per_thread; i++) {
+        auto record = MakeRecord(tid, i);
+        const lsn_t lsn = log_writer->Append(record.data(), record.size());
+        if (log_writer->WaitDurable(lsn) < lsn || log_writer->GetDurableLSN() < lsn) {
+          not_durable[tid]++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    EXPECT_EQ(0, not_durable[tid]);
+  }
+  const auto num_commits = static_cast<lsn_t>(num_threads * commits_per_thread);
+  EXPECT_EQ(num_commits - 1, log_writer->GetDurableLSN());
+  EXPECT_LT(log_writer->GetNumSyncs(), num_commits);
+  log_writer.reset();
+
+  // Scenario: every record made it into the log exactly once, and each thread's records are in order.
+  const size_t record_size = MakeRecord(0, 0).size();
+  std::vector<char> buf(record_size);
+  std::vector<size_t> next_seq(num_threads, 0);
+  for (lsn_t lsn = 0; lsn < num_commits; lsn++) {
+    ASSERT_TRUE(dm.ReadLog(buf.data(), static_cast<int>(record_size), static_cast<int>(lsn * record_size)));
+    size_t writer;
+    size_t seq;
+    ASSERT_EQ(2, sscanf(buf.data(), "writer %zu record %zu", &writer, &seq));
+    ASSERT_LT(writer, num_threads);
+    EXPECT_EQ(next_seq[writer]++, seq);
+  }
+  EXPECT_FALSE(dm.ReadLog(buf.data(), static_cast<int>(record_size), static_cast<int>(num_commits * record_size)));
+
+  dm.ShutDown();
+}
+
+}  // namespace bustub
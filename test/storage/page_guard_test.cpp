@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/page_guard.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, BasicTest) {
+  const size_t buffer_pool_size = 5;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+
+  // Scenario: A guard unpins its page when it goes out of scope.
+  {
+    auto guard = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(page_id, guard.PageId());
+    EXPECT_EQ(page->GetData(), guard.GetData());
+    EXPECT_EQ(2, page->GetPinCount());
+  }
+  EXPECT_EQ(1, page->GetPinCount());
+
+  // Scenario: Moving a guard moves the pin, and assigning to a guard drops the pin it held.
+  {
+    auto guard = bpm->FetchPageBasic(page_id);
+    auto moved = std::move(guard);
+    EXPECT_FALSE(guard.IsValid());  // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ(2, page->GetPinCount());
+    moved = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    moved.Drop();
+    EXPECT_FALSE(moved.IsValid());
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(1, page->GetPinCount());
+
+  // Scenario: Writing through a guard marks the page dirty when the guard is dropped.
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  bpm->FlushPage(page_id);
+  EXPECT_FALSE(page->IsDirty());
+  {
+    auto guard = bpm->FetchPageWrite(page_id);
+    snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "Hello");
+  }
+  EXPECT_TRUE(page->IsDirty());
+  EXPECT_EQ(0, page->GetPinCount());
+  {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, LatchTest) {
+  const size_t buffer_pool_size = 5;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  {
+    auto guard = bpm->NewPageGuarded(&page_id);
+    ASSERT_TRUE(guard.IsValid());
+  }
+
+  // Scenario: Read guards share the page, and hold off writers until all of them are gone.
+  uint64_t version;
+  {
+    auto first = bpm->FetchPageRead(page_id);
+    auto second = bpm->FetchPageBasic(page_id).UpgradeRead();
+    ASSERT_TRUE(second.IsValid());
+    EXPECT_TRUE(bpm->FetchPageBasic(page_id).GetPage()->TryOptimisticRLatch(&version));
+  }
+
+  // Scenario: A write guard latches the page exclusively until it is dropped or moved from.
+  {
+    auto basic = bpm->FetchPageBasic(page_id);
+    auto write = basic.UpgradeWrite();
+    EXPECT_FALSE(basic.IsValid());  // NOLINT(bugprone-use-after-move)
+    auto moved = std::move(write);
+    EXPECT_FALSE(bpm->FetchPageBasic(page_id).GetPage()->TryOptimisticRLatch(&version));
+    moved.Drop();
+    EXPECT_TRUE(bpm->FetchPageBasic(page_id).GetPage()->TryOptimisticRLatch(&version));
+  }
+
+  // Scenario: Once every frame is pinned, guarded fetches come back empty instead of returning nullptr pages.
+  std::vector<BasicPageGuard> guards;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t new_page_id;
+    guards.push_back(bpm->NewPageGuarded(&new_page_id));
+    ASSERT_TRUE(guards.back().IsValid());
+  }
+  EXPECT_FALSE(bpm->FetchPageRead(page_id).IsValid());
+  EXPECT_FALSE(bpm->FetchPageWrite(page_id).IsValid());
+
+  // Scenario: Dropping the guards frees up the pool again.
+  guards.clear();
+  EXPECT_TRUE(bpm->FetchPageRead(page_id).IsValid());
+}
+
+}  // namespace bustub
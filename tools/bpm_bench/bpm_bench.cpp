@@ -0,0 +1,336 @@
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "container/hash/extendible_hash_table.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+/**
+ * bpm-bench runs micro benchmarks against the buffer pool manager. Every benchmark is backed by an in-memory disk
+ * manager, so the numbers only reflect the cost of the buffer pool itself.
+ */
+
+static const size_t BPM_BENCH_MIN_POOL_SIZE = 1024;
+static const size_t BPM_BENCH_MAX_POOL_SIZE = 65536;
+static const size_t BPM_BENCH_OPS = 100000;
+static const size_t BPM_BENCH_MAX_THREADS = 64;
+static const size_t BPM_BENCH_LRU_K_MAX_POOL_SIZE = 1 << 20;
+static const uint64_t BPM_BENCH_BASELINE_NS = 2000000000;
+
+auto ClockNs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * Measure the latency of a buffer pool miss for growing pool sizes.
+ *
+ * Half of the frames are held pinned, as if by concurrent queries. The other pages are scanned cyclically over a range
+ * twice as large as the unpinned frames, so every fetch misses and evicts a clean frame. The latency should stay flat
+ * as the pool grows.
+ */
+void MissLatencyBench(size_t max_pool_size, size_t ops) {
+  fmt::print("<<< BEGIN miss latency\n");
+  fmt::print("{:>12} {:>14}\n", "pool_size", "ns/miss");
+  for (size_t pool_size = BPM_BENCH_MIN_POOL_SIZE; pool_size <= max_pool_size; pool_size *= 4) {
+    auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+
+    // The first half of the pool stays pinned for the whole measurement.
+    const auto num_pinned = static_cast<bustub::page_id_t>(pool_size / 2);
+    for (bustub::page_id_t i = 0; i < num_pinned; i++) {
+      bustub::page_id_t page_id;
+      bpm->NewPage(&page_id);
+    }
+
+    // Create the scanned pages, so that every later fetch can read them back from the disk manager.
+    const auto num_scanned = static_cast<bustub::page_id_t>(pool_size);
+    for (bustub::page_id_t i = 0; i < num_scanned; i++) {
+      bustub::page_id_t page_id;
+      bpm->NewPage(&page_id);
+      bpm->UnpinPage(page_id, true);
+    }
+
+    auto start = ClockNs();
+    for (size_t i = 0; i < ops; i++) {
+      auto page_id = num_pinned + static_cast<bustub::page_id_t>(i % num_scanned);
+      bpm->FetchPage(page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+    auto elapsed = ClockNs() - start;
+    fmt::print("{:>12} {:>14.1f}\n", pool_size, static_cast<double>(elapsed) / ops);
+  }
+  fmt::print(">>> END\n");
+}
+
+/**
+ * Measure how long it takes to build and destroy a buffer pool, for growing pool sizes. Frame memory is only touched
+ * when a frame is first used, so this should stay far below the time it takes to zero the whole pool.
+ */
+void StartupBench(size_t max_pool_size) {
+  fmt::print("<<< BEGIN startup (huge_pages={})\n", bustub::buffer_pool_huge_pages.load());
+  fmt::print("{:>12} {:>14} {:>14}\n", "pool_size", "us/create", "us/destroy");
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  for (size_t pool_size = BPM_BENCH_MIN_POOL_SIZE; pool_size <= max_pool_size; pool_size *= 4) {
+    auto start = ClockNs();
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+    auto created = ClockNs();
+    bpm.reset();
+    auto destroyed = ClockNs();
+    fmt::print("{:>12} {:>14.1f} {:>14.1f}\n", pool_size, static_cast<double>(created - start) / 1000,
+               static_cast<double>(destroyed - created) / 1000);
+  }
+  fmt::print(">>> END\n");
+}
+
+/**
+ * Run lookup_fn(key) for ops keys in each of num_threads threads, and return the total lookups per microsecond.
+ */
+template <typename LookupFn>
+auto LookupThroughput(size_t num_threads, size_t num_keys, size_t ops, LookupFn lookup_fn) -> double {
+  std::vector<std::thread> threads;
+  auto start = ClockNs();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([tid, num_keys, ops, &lookup_fn]() {
+      // Every thread visits the keys in a different order, like hits on a shared working set.
+      size_t key = tid * 7919;
+      for (size_t i = 0; i < ops; i++) {
+        key = (key + 104729) % num_keys;
+        lookup_fn(static_cast<bustub::page_id_t>(key));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockNs() - start;
+  return static_cast<double>(num_threads * ops) * 1000 / static_cast<double>(elapsed);
+}
+
+/**
+ * Compare the lookup throughput of the buffer pool's PageTable against the ExtendibleHashTable it replaced, for a
+ * table full of pages and growing numbers of threads. Every lookup is a hit.
+ */
+void PageTableBench(size_t pool_size, size_t max_threads, size_t ops) {
+  bustub::ExtendibleHashTable<bustub::page_id_t, bustub::frame_id_t> extendible_table(4);
+  bustub::PageTable page_table(pool_size);
+  for (size_t i = 0; i < pool_size; i++) {
+    extendible_table.Insert(static_cast<bustub::page_id_t>(i), static_cast<bustub::frame_id_t>(i));
+    page_table.Insert(static_cast<bustub::page_id_t>(i), static_cast<bustub::frame_id_t>(i));
+  }
+
+  fmt::print("<<< BEGIN page table lookups (pool_size={})\n", pool_size);
+  fmt::print("{:>8} {:>20} {:>20}\n", "threads", "extendible Mops/s", "page_table Mops/s");
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    auto extendible_mops = LookupThroughput(num_threads, pool_size, ops, [&](bustub::page_id_t page_id) {
+      bustub::frame_id_t frame_id;
+      extendible_table.Find(page_id, frame_id);
+    });
+    auto page_table_mops = LookupThroughput(num_threads, pool_size, ops, [&](bustub::page_id_t page_id) {
+      bustub::frame_id_t frame_id;
+      page_table.Find(page_id, frame_id);
+    });
+    fmt::print("{:>8} {:>20.2f} {:>20.2f}\n", num_threads, extendible_mops, page_table_mops);
+  }
+  fmt::print(">>> END\n");
+}
+
+/**
+ * The list-based LRU-k replacer that LRUKReplacer replaced, kept as the baseline of LruKBench. RecordAccess() removes
+ * the frame from a list, and Evict() scans the lists for an evictable frame, both in O(n).
+ */
+class ListLRUKReplacer {
+ public:
+  explicit ListLRUKReplacer(size_t k) : k_(k) {}
+
+  auto Evict(bustub::frame_id_t *frame_id) -> bool {
+    for (auto *list : {&lru_list_, &lru_k_list_}) {
+      for (auto it = list->begin(); it != list->end(); ++it) {
+        if (is_evictable_map_[*it]) {
+          *frame_id = *it;
+          access_count_map_.erase(*it);
+          is_evictable_map_.erase(*it);
+          list->erase(it);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void RecordAccess(bustub::frame_id_t frame_id) {
+    const size_t count = ++access_count_map_[frame_id];
+    if (count < k_) {
+      if (count > 1) {
+        lru_list_.remove(frame_id);
+      }
+      lru_list_.push_back(frame_id);
+    } else {
+      (count == k_ ? lru_list_ : lru_k_list_).remove(frame_id);
+      lru_k_list_.push_back(frame_id);
+    }
+  }
+
+  void SetEvictable(bustub::frame_id_t frame_id, bool set_evictable) { is_evictable_map_[frame_id] = set_evictable; }
+
+ private:
+  size_t k_;
+  std::list<bustub::frame_id_t> lru_k_list_;
+  std::list<bustub::frame_id_t> lru_list_;
+  std::unordered_map<bustub::frame_id_t, size_t> access_count_map_;
+  std::unordered_map<bustub::frame_id_t, bool> is_evictable_map_;
+};
+
+/**
+ * Replay the replacer calls of a buffer pool against a replacer with num_frames evictable frames, and return ns/op.
+ *
+ * Each operation is a hit on a random frame (access, pin, unpin) nine times out of ten, and a miss (evict, then access
+ * and unpin the victim) otherwise. The replay stops early after max_ns, and the average is taken over the operations
+ * that finished by then.
+ */
+template <typename Replacer>
+auto ReplacerLatency(Replacer *replacer, size_t num_frames, size_t ops, uint64_t max_ns) -> double {
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer->RecordAccess(static_cast<bustub::frame_id_t>(i));
+    replacer->SetEvictable(static_cast<bustub::frame_id_t>(i), true);
+  }
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<bustub::frame_id_t> frame_dist(0, static_cast<bustub::frame_id_t>(num_frames - 1));
+  auto start = ClockNs();
+  size_t done = 0;
+  for (; done < ops && (done % 64 != 0 || ClockNs() - start < max_ns); done++) {
+    bustub::frame_id_t frame_id = frame_dist(gen);
+    if (done % 10 == 9) {
+      replacer->Evict(&frame_id);
+      replacer->RecordAccess(frame_id);
+    } else {
+      replacer->RecordAccess(frame_id);
+      replacer->SetEvictable(frame_id, false);
+    }
+    replacer->SetEvictable(frame_id, true);
+  }
+  return static_cast<double>(ClockNs() - start) / static_cast<double>(done);
+}
+
+/**
+ * Compare the cost of LRUKReplacer against the list-based replacer it replaced, for growing numbers of frames. The
+ * list-based replacer is given at most BPM_BENCH_BASELINE_NS per pool size, as it slows down linearly.
+ */
+void LruKBench(size_t max_pool_size, size_t ops) {
+  fmt::print("<<< BEGIN lru-k replacer (k={})\n", bustub::LRUK_REPLACER_K);
+  fmt::print("{:>12} {:>14} {:>14}\n", "pool_size", "list ns/op", "heap ns/op");
+  for (size_t pool_size = BPM_BENCH_MIN_POOL_SIZE; pool_size <= max_pool_size; pool_size *= 4) {
+    ListLRUKReplacer list_replacer(bustub::LRUK_REPLACER_K);
+    auto list_ns = ReplacerLatency(&list_replacer, pool_size, ops, BPM_BENCH_BASELINE_NS);
+    bustub::LRUKReplacer heap_replacer(pool_size, bustub::LRUK_REPLACER_K);
+    auto heap_ns = ReplacerLatency(&heap_replacer, pool_size, ops, UINT64_MAX);
+    fmt::print("{:>12} {:>14.1f} {:>14.1f}\n", pool_size, list_ns, heap_ns);
+  }
+  fmt::print(">>> END\n");
+}
+
+/**
+ * Compare the throughput of the buffer pool's hit path in every replacer, for a replacer full of evictable frames and
+ * growing numbers of threads. A hit records an access and pins and unpins the frame, like FetchPage() and UnpinPage().
+ */
+void ReplacerHitBench(size_t pool_size, size_t max_threads, size_t ops) {
+  const std::vector<bustub::ReplacerPolicy> policies = {bustub::ReplacerPolicy::LRU, bustub::ReplacerPolicy::CLOCK,
+                                                        bustub::ReplacerPolicy::LRU_K, bustub::ReplacerPolicy::ARC,
+                                                        bustub::ReplacerPolicy::TWO_Q};
+  fmt::print("<<< BEGIN replacer hits (pool_size={})\n", pool_size);
+  fmt::print("{:>8}", "threads");
+  for (auto policy : policies) {
+    fmt::print(" {:>14}", bustub::ReplacerPolicyToString(policy) + " Mops/s");
+  }
+  fmt::print("\n");
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    fmt::print("{:>8}", num_threads);
+    for (auto policy : policies) {
+      std::unique_ptr<bustub::Replacer> replacer(bustub::CreateReplacer(policy, pool_size, bustub::LRUK_REPLACER_K));
+      for (size_t i = 0; i < pool_size; i++) {
+        replacer->SetPageId(static_cast<bustub::frame_id_t>(i), static_cast<bustub::page_id_t>(i));
+        replacer->RecordAccess(static_cast<bustub::frame_id_t>(i));
+        replacer->SetEvictable(static_cast<bustub::frame_id_t>(i), true);
+      }
+      auto mops = LookupThroughput(num_threads, pool_size, ops, [&](bustub::page_id_t page_id) {
+        replacer->RecordAccess(page_id);
+        replacer->SetEvictable(page_id, false);
+        replacer->SetEvictable(page_id, true);
+      });
+      fmt::print(" {:>14.2f}", mops);
+    }
+    fmt::print("\n");
+  }
+  fmt::print(">>> END\n");
+}
+
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--bench")
+      .help("benchmark to run: miss, page-table, startup, lru-k, replacer-hits")
+      .default_value(std::string("miss"));
+  program.add_argument("--max-pool-size").help("largest buffer pool size (in frames) to benchmark");
+  program.add_argument("--max-threads").help("largest number of threads to benchmark");
+  program.add_argument("--huge-pages").help("back the buffer pool with explicit huge pages: 0 or 1");
+  program.add_argument("--ops").help("number of operations per measurement");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t max_pool_size = BPM_BENCH_MAX_POOL_SIZE;
+  if (program.present("--max-pool-size")) {
+    max_pool_size = std::stoul(program.get("--max-pool-size"));
+  }
+
+  size_t ops = BPM_BENCH_OPS;
+  if (program.present("--ops")) {
+    ops = std::stoul(program.get("--ops"));
+  }
+
+  size_t max_threads = BPM_BENCH_MAX_THREADS;
+  if (program.present("--max-threads")) {
+    max_threads = std::stoul(program.get("--max-threads"));
+  }
+
+  if (program.present("--huge-pages")) {
+    bustub::buffer_pool_huge_pages = std::stoi(program.get("--huge-pages")) != 0;
+  }
+
+  auto bench = program.get("--bench");
+  if (bench == "miss") {
+    MissLatencyBench(max_pool_size, ops);
+  } else if (bench == "page-table") {
+    PageTableBench(max_pool_size, max_threads, ops);
+  } else if (bench == "startup") {
+    StartupBench(max_pool_size);
+  } else if (bench == "lru-k") {
+    LruKBench(program.present("--max-pool-size") ? max_pool_size : BPM_BENCH_LRU_K_MAX_POOL_SIZE, ops);
+  } else if (bench == "replacer-hits") {
+    ReplacerHitBench(max_pool_size, max_threads, ops);
+  } else {
+    std::cerr << "unknown benchmark: " << bench << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,337 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "common/util/crc32c.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/log_writer.h"
+
+/**
+ * disk-bench runs the buffer pool against a real database file, to compare the I/O modes of DiskManager. Unlike
+ * bpm-bench, the numbers include the cost of the kernel and the device.
+ */
+
+static const size_t DISK_BENCH_POOL_SIZE = 1024;
+static const size_t DISK_BENCH_PAGES = 16384;
+static const size_t DISK_BENCH_OPS = 100000;
+static const double DISK_BENCH_WRITE_FRACTION = 0.1;
+static const size_t DISK_BENCH_MAX_THREADS = 64;
+static const uint64_t DISK_BENCH_COMMIT_NS = 1000000000;
+static const size_t DISK_BENCH_COMMIT_RECORD_SIZE = 64;
+
+auto ClockNs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** @return the resident set size of this process in bytes */
+auto ResidentBytes() -> size_t {
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  statm >> total_pages >> resident_pages;
+  return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/** @return the bytes of the file that are in the kernel page cache, which the resident set size does not include */
+auto CachedBytes(const std::string &file_name) -> size_t {
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat stat_buf;
+  if (fd < 0 || fstat(fd, &stat_buf) != 0 || stat_buf.st_size == 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    return 0;
+  }
+  const auto size = static_cast<size_t>(stat_buf.st_size);
+  const auto os_page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return 0;
+  }
+  // Mapping the file does not fault it in, mincore() only reports what the page cache already holds.
+#if defined(__linux__)
+  std::vector<unsigned char> resident((size + os_page_size - 1) / os_page_size);
+#else
+  std::vector<char> resident((size + os_page_size - 1) / os_page_size);
+#endif
+  size_t cached = 0;
+  if (mincore(static_cast<char *>(data), size, resident.data()) == 0) {
+    for (auto page : resident) {
+      cached += (page & 1) * os_page_size;
+    }
+  }
+  munmap(data, size);
+  return cached;
+}
+
+/**
+ * Write back and drop the file's pages from the kernel page cache, so that every run starts cold. Only Linux can drop
+ * them, elsewhere they are only written back.
+ */
+void DropCache(const std::string &file_name) {
+  const int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd >= 0) {
+#if defined(__linux__)
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#else
+    fsync(fd);
+#endif
+    close(fd);
+  }
+}
+
+/** Create a database file with num_pages pages, and their checksums if enable_page_checksums is set. */
+void CreateDatabaseFile(const std::string &file_name, size_t num_pages) {
+  remove(file_name.c_str());
+  bustub::DiskManager disk_manager(file_name);
+  std::vector<char> data(bustub::BUSTUB_PAGE_SIZE);
+  for (size_t i = 0; i < num_pages; i++) {
+    snprintf(data.data(), data.size(), "page %zu", i);
+    disk_manager.WritePage(disk_manager.AllocatePage(), data.data());
+  }
+  disk_manager.ShutDown();
+}
+
+/**
+ * Run ops uniformly random fetches over num_pages pages, a write_fraction of which dirty the page, and flush the buffer
+ * pool at the end.
+ * @return the elapsed time in nanoseconds
+ */
+auto RunFetches(bustub::BufferPoolManager *bpm, size_t num_pages, size_t ops, double write_fraction) -> uint64_t {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<bustub::page_id_t> page_dist(0, static_cast<bustub::page_id_t>(num_pages - 1));
+  std::uniform_real_distribution<double> write_dist(0, 1);
+  auto start = ClockNs();
+  for (size_t i = 0; i < ops; i++) {
+    const bustub::page_id_t page_id = page_dist(gen);
+    bustub::Page *page = bpm->FetchPage(page_id);
+    const bool dirty = write_dist(gen) < write_fraction;
+    if (dirty) {
+      page->GetData()[bustub::BUSTUB_PAGE_SIZE - 1]++;
+    }
+    bpm->UnpinPage(page_id, dirty);
+  }
+  bpm->FlushAllPages();
+  return ClockNs() - start;
+}
+
+/**
+ * Compare buffered and direct I/O for a workload larger than the buffer pool: uniformly random fetches over num_pages
+ * pages, a write_fraction of which dirty the page. Reports the throughput, the resident set size, and how much of the
+ * database file the kernel page cache holds on top of the buffer pool.
+ */
+void DirectIOBench(const std::string &file_name, size_t pool_size, size_t num_pages, size_t ops,
+                   double write_fraction) {
+  CreateDatabaseFile(file_name, num_pages);
+
+  fmt::print("<<< BEGIN direct I/O (pool_size={}, pages={}, write_fraction={})\n", pool_size, num_pages,
+             write_fraction);
+  fmt::print("{:>10} {:>10} {:>10} {:>10} {:>12}\n", "mode", "Kops/s", "MiB/s", "rss MiB", "cached MiB");
+  for (bool direct_io : {false, true}) {
+    DropCache(file_name);
+    auto disk_manager = std::make_unique<bustub::DiskManager>(file_name, direct_io);
+    auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+    auto elapsed = RunFetches(bpm.get(), num_pages, ops, write_fraction);
+
+    const int num_io = static_cast<int>(bpm->GetStats().misses_) + disk_manager->GetNumWrites();
+    const double seconds = static_cast<double>(elapsed) / 1e9;
+    fmt::print("{:>10} {:>10.1f} {:>10.1f} {:>10.1f} {:>12.1f}\n", disk_manager->UsesDirectIO() ? "direct" : "buffered",
+               static_cast<double>(ops) / seconds / 1000,
+               static_cast<double>(num_io) * bustub::BUSTUB_PAGE_SIZE / seconds / (1 << 20),
+               static_cast<double>(ResidentBytes()) / (1 << 20), static_cast<double>(CachedBytes(file_name)) / (1 << 20));
+    disk_manager->ShutDown();
+  }
+  fmt::print(">>> END\n");
+  remove(file_name.c_str());
+}
+
+/**
+ * Run commit_fn() in each of num_threads threads for DISK_BENCH_COMMIT_NS, and return the total commits per second.
+ */
+template <typename CommitFn>
+auto CommitThroughput(size_t num_threads, CommitFn commit_fn) -> double {
+  std::vector<std::thread> threads;
+  std::vector<size_t> commits(num_threads, 0);
+  const auto start = ClockNs();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      while (ClockNs() - start < DISK_BENCH_COMMIT_NS) {
+        commit_fn();
+        commits[tid]++;
+      }
+    });
+  }
+  size_t total = 0;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads[tid].join();
+    total += commits[tid];
+  }
+  return static_cast<double>(total) * 1e9 / static_cast<double>(ClockNs() - start);
+}
+
+/**
+ * Compare the commit throughput of LogWriter's group commit against one durable log write per commit, for growing
+ * numbers of concurrent committers. Every commit appends a DISK_BENCH_COMMIT_RECORD_SIZE byte record.
+ */
+void GroupCommitBench(const std::string &file_name, size_t max_threads) {
+  const std::vector<char> record(DISK_BENCH_COMMIT_RECORD_SIZE, 'r');
+  fmt::print("<<< BEGIN group commit (record_size={})\n", record.size());
+  fmt::print("{:>8} {:>18} {:>18} {:>16}\n", "threads", "per-commit sync/s", "group commit/s", "commits/sync");
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    double single_commits;
+    {
+      remove(file_name.c_str());
+      bustub::DiskManager disk_manager(file_name);
+      // WriteLog() wants the buffers to alternate.
+      std::vector<char> buffers[2] = {record, record};
+      size_t next_buffer = 0;
+      std::mutex latch;
+      single_commits = CommitThroughput(num_threads, [&]() {
+        std::scoped_lock lock(latch);
+        disk_manager.WriteLog(buffers[next_buffer].data(), static_cast<int>(record.size()));
+        next_buffer ^= 1;
+      });
+      disk_manager.ShutDown();
+    }
+
+    double group_commits;
+    double commits_per_sync;
+    {
+      remove(file_name.c_str());
+      bustub::DiskManager disk_manager(file_name);
+      bustub::LogWriter log_writer(&disk_manager);
+      group_commits = CommitThroughput(num_threads, [&]() { log_writer.Commit(record.data(), record.size()); });
+      commits_per_sync = static_cast<double>(log_writer.GetDurableLSN() + 1) /
+                         static_cast<double>(std::max<size_t>(1, log_writer.GetNumSyncs()));
+    }
+    fmt::print("{:>8} {:>18.0f} {:>18.0f} {:>16.1f}\n", num_threads, single_commits, group_commits,
+               commits_per_sync);
+  }
+  fmt::print(">>> END\n");
+  remove(file_name.c_str());
+  remove((file_name.substr(0, file_name.rfind('.')) + ".log").c_str());
+}
+
+/**
+ * Measure the cost of page checksums: CRC-32C of a page with and without SSE4.2, and the throughput of the
+ * DirectIOBench workload with checksums off and on. With buffered I/O, the database file stays in the page cache, so the
+ * I/O is as cheap as it gets and the checksums' share of the cost as large as it gets. Each mode is run a few times,
+ * alternating with the other, and reports its best run.
+ */
+void ChecksumBench(const std::string &file_name, size_t pool_size, size_t num_pages, size_t ops,
+                   double write_fraction) {
+  std::vector<char> page(bustub::BUSTUB_PAGE_SIZE);
+  std::mt19937 gen(42);
+  for (auto &byte : page) {
+    byte = static_cast<char>(gen());
+  }
+  const size_t num_checksums = 1 << 18;
+  fmt::print("<<< BEGIN page checksum (sse4.2={}, pool_size={}, pages={}, write_fraction={})\n",
+             bustub::Crc32c::HasHardwareSupport(), pool_size, num_pages, write_fraction);
+  fmt::print("{:>10} {:>10} {:>10}\n", "crc32c", "ns/page", "GiB/s");
+  for (bool hardware : {true, false}) {
+    uint32_t checksum = 0;
+    auto start = ClockNs();
+    for (size_t i = 0; i < num_checksums; i++) {
+      // Chain the checksums, so that the compiler cannot skip any of them.
+      page[0] = static_cast<char>(checksum);
+      checksum = hardware ? bustub::Crc32c::Compute(page.data(), page.size())
+                          : bustub::Crc32c::ComputeSoftware(page.data(), page.size());
+    }
+    const auto elapsed = static_cast<double>(ClockNs() - start);
+    fmt::print("{:>10} {:>10.1f} {:>10.2f}\n", hardware ? "hardware" : "software", elapsed / num_checksums,
+               static_cast<double>(num_checksums * page.size()) / elapsed * 1e9 / (1 << 30));
+  }
+
+  const int num_trials = 3;
+  fmt::print("{:>10} {:>10} {:>10} {:>10}\n", "mode", "checksums", "Kops/s", "overhead");
+  for (bool direct_io : {false, true}) {
+    double best_kops[2] = {0, 0};
+    for (int trial = 0; trial < num_trials; trial++) {
+      for (bool checksums : {false, true}) {
+        bustub::enable_page_checksums = checksums;
+        CreateDatabaseFile(file_name, num_pages);
+        auto disk_manager = std::make_unique<bustub::DiskManager>(file_name, direct_io);
+        auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+        if (!direct_io) {
+          // Warm up the page cache.
+          RunFetches(bpm.get(), num_pages, ops, write_fraction);
+        }
+        const auto elapsed = static_cast<double>(RunFetches(bpm.get(), num_pages, ops, write_fraction));
+        best_kops[checksums ? 1 : 0] = std::max(best_kops[checksums ? 1 : 0], static_cast<double>(ops) / elapsed * 1e6);
+        disk_manager->ShutDown();
+      }
+    }
+    for (bool checksums : {false, true}) {
+      fmt::print("{:>10} {:>10} {:>10.1f} {:>9.1f}%\n", direct_io ? "direct" : "buffered", checksums ? "on" : "off",
+                 best_kops[checksums ? 1 : 0], (best_kops[0] / best_kops[checksums ? 1 : 0] - 1) * 100);
+    }
+  }
+  bustub::enable_page_checksums = true;
+  fmt::print(">>> END\n");
+}
+
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-bench");
+  program.add_argument("--bench")
+      .help("benchmark to run: direct-io, group-commit, checksum")
+      .default_value(std::string("direct-io"));
+  program.add_argument("--file").help("database file to create").default_value(std::string("disk_bench.db"));
+  program.add_argument("--pool-size").help("buffer pool size (in frames)");
+  program.add_argument("--pages").help("number of pages in the database file");
+  program.add_argument("--ops").help("number of operations per measurement");
+  program.add_argument("--write-fraction").help("fraction of the fetches that dirty the page");
+  program.add_argument("--max-threads").help("largest number of concurrent committers to benchmark");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  const size_t pool_size =
+      program.present("--pool-size") ? std::stoul(program.get("--pool-size")) : DISK_BENCH_POOL_SIZE;
+  const size_t num_pages = program.present("--pages") ? std::stoul(program.get("--pages")) : DISK_BENCH_PAGES;
+  const size_t ops = program.present("--ops") ? std::stoul(program.get("--ops")) : DISK_BENCH_OPS;
+  const double write_fraction = program.present("--write-fraction") ? std::stod(program.get("--write-fraction"))
+                                                                     : DISK_BENCH_WRITE_FRACTION;
+  const size_t max_threads =
+      program.present("--max-threads") ? std::stoul(program.get("--max-threads")) : DISK_BENCH_MAX_THREADS;
+
+  auto bench = program.get("--bench");
+  if (bench == "direct-io") {
+    DirectIOBench(program.get("--file"), pool_size, num_pages, ops, write_fraction);
+  } else if (bench == "checksum") {
+    ChecksumBench(program.get("--file"), pool_size, num_pages, ops, write_fraction);
+  } else if (bench == "group-commit") {
+    GroupCommitBench(program.get("--file"), max_threads);
+  } else {
+    std::cerr << "unknown benchmark: " << bench << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,335 @@
+#include <malloc.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/access_trace.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/util/string_util.h"
+#include "fmt/core.h"
+
+/**
+ * replacer-bench replays a page access trace against each replacement policy, the way a buffer pool drives its
+ * replacer, and reports the hit ratio, the cost of the replacer and its memory overhead for several pool sizes. The
+ * trace is either recorded from the buffer pool with `\bptrace` in the shell, or generated: Zipfian point accesses,
+ * optionally mixed with sequential scans.
+ */
+
+static const size_t REPLACER_BENCH_PAGES = 1 << 16;
+static const size_t REPLACER_BENCH_ACCESSES = 1 << 20;
+static const double REPLACER_BENCH_THETA = 0.9;
+static const double REPLACER_BENCH_SCAN_FRACTION = 0.3;
+
+/** @return the bytes currently allocated on the heap, including large blocks that malloc maps separately */
+auto HeapBytes() -> size_t {
+  const auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+auto ClockNs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * Draws ranks in [0, n) from a Zipfian distribution with skew theta (0 < theta < 1), like YCSB: rank 0 is the most
+ * popular one. Setting it up takes O(n), drawing a rank O(1).
+ */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(size_t n, double theta) : n_(n), theta_(theta), alpha_(1.0 / (1.0 - theta)) {
+    for (size_t i = 1; i <= n; i++) {
+      zeta_n_ += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    const double zeta_2 = 1.0 + std::pow(0.5, theta);
+    eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - zeta_2 / zeta_n_);
+  }
+
+  template <typename Gen>
+  auto Next(Gen &gen) -> size_t {
+    const double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+    const double uz = u * zeta_n_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    return std::min(n_ - 1, static_cast<size_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_)));
+  }
+
+ private:
+  size_t n_;
+  double theta_;
+  double alpha_;
+  double zeta_n_{0};
+  double eta_;
+};
+
+/**
+ * Generate num_accesses fetches over num_pages pages. A fraction scan_fraction of them belongs to sequential scans of
+ * scan_length pages from a random start, the others are Zipfian point accesses. The ranks are scattered over the page
+ * ids, so that the hot pages are not next to each other.
+ */
+auto GenerateTrace(size_t num_pages, size_t num_accesses, double theta, double scan_fraction, size_t scan_length,
+                   uint64_t seed) -> std::vector<bustub::AccessRecord> {
+  std::mt19937_64 gen(seed);
+  ZipfianGenerator zipf(num_pages, theta);
+  std::uniform_int_distribution<size_t> page_dist(0, num_pages - 1);
+  // Starting a scan with probability p before each point access makes scans p * L / (1 + p * L) of all accesses.
+  const double scan_probability =
+      scan_fraction <= 0 ? 0 : scan_fraction / ((1.0 - scan_fraction) * static_cast<double>(scan_length));
+  std::bernoulli_distribution scan_dist(std::min(1.0, scan_probability));
+  // Multiplying by a number coprime with num_pages maps the ranks one to one onto the pages. Near the golden ratio of
+  // num_pages, consecutive ranks land far apart.
+  size_t scatter = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(num_pages) * 0.618));
+  while (std::gcd(scatter, num_pages) != 1) {
+    scatter++;
+  }
+
+  std::vector<bustub::AccessRecord> trace;
+  trace.reserve(num_accesses);
+  while (trace.size() < num_accesses) {
+    if (scan_dist(gen)) {
+      const size_t start = page_dist(gen);
+      for (size_t i = 0; i < scan_length && trace.size() < num_accesses; i++) {
+        trace.push_back({bustub::AccessType::FETCH, static_cast<bustub::page_id_t>((start + i) % num_pages)});
+      }
+    } else {
+      const size_t rank = zipf.Next(gen);
+      trace.push_back({bustub::AccessType::FETCH, static_cast<bustub::page_id_t>(rank * scatter % num_pages)});
+    }
+  }
+  return trace;
+}
+
+struct ReplayResult {
+  double hit_ratio_;
+  double ns_per_access_;
+  double ns_per_evict_;
+  double bytes_per_frame_;
+};
+
+/**
+ * Replay a trace against a replacer for a buffer pool of pool_size frames, without any page data. A fetch that hits
+ * pins and unpins the frame, a fetch that misses and a new page take a free frame or evict one, and a delete frees the
+ * frame of the page. The hit ratio only counts fetches.
+ *
+ * The page table is a dense array over the page ids of the trace and the free list is allocated up front, so that the
+ * replacer is the only thing that allocates during the replay. Its memory overhead is the growth of the heap from
+ * before it was created to the end of the replay, when the ghost lists of ARC and 2Q are full.
+ */
+auto Replay(bustub::ReplacerPolicy policy, size_t k, size_t pool_size, const std::vector<bustub::AccessRecord> &trace,
+            size_t num_page_ids) -> ReplayResult {
+  std::vector<bustub::frame_id_t> page_table(num_page_ids, -1);
+  std::vector<bustub::page_id_t> frame_pages(pool_size, bustub::INVALID_PAGE_ID);
+  std::vector<bustub::frame_id_t> free_frames;
+  free_frames.reserve(pool_size);
+  for (size_t i = pool_size; i > 0; i--) {
+    free_frames.push_back(static_cast<bustub::frame_id_t>(i - 1));
+  }
+
+  const size_t heap_bytes = HeapBytes();
+  std::unique_ptr<bustub::Replacer> replacer(bustub::CreateReplacer(policy, pool_size, k));
+
+  size_t fetches = 0;
+  size_t hits = 0;
+  size_t evictions = 0;
+  uint64_t evict_ns = 0;
+  const uint64_t start = ClockNs();
+  for (const auto &access : trace) {
+    bustub::frame_id_t &page_frame = page_table[access.page_id_];
+    if (access.type_ == bustub::AccessType::DELETE) {
+      if (page_frame != -1) {
+        replacer->Remove(page_frame);
+        free_frames.push_back(page_frame);
+        frame_pages[page_frame] = bustub::INVALID_PAGE_ID;
+        page_frame = -1;
+      }
+      continue;
+    }
+
+    if (access.type_ == bustub::AccessType::FETCH) {
+      fetches++;
+    }
+    if (page_frame != -1) {
+      hits += access.type_ == bustub::AccessType::FETCH ? 1 : 0;
+      replacer->RecordAccess(page_frame);
+      replacer->SetEvictable(page_frame, false);
+      replacer->SetEvictable(page_frame, true);
+      continue;
+    }
+
+    bustub::frame_id_t frame_id;
+    if (!free_frames.empty()) {
+      frame_id = free_frames.back();
+      free_frames.pop_back();
+    } else {
+      const uint64_t evict_start = ClockNs();
+      replacer->Evict(&frame_id);
+      evict_ns += ClockNs() - evict_start;
+      evictions++;
+      page_table[frame_pages[frame_id]] = -1;
+    }
+    frame_pages[frame_id] = access.page_id_;
+    page_frame = frame_id;
+    replacer->SetPageId(frame_id, access.page_id_);
+    replacer->RecordAccess(frame_id);
+    replacer->SetEvictable(frame_id, true);
+  }
+  const uint64_t elapsed = ClockNs() - start;
+  const size_t replacer_bytes = HeapBytes() - heap_bytes;
+
+  return {fetches == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(fetches),
+          trace.empty() ? 0 : static_cast<double>(elapsed) / static_cast<double>(trace.size()),
+          evictions == 0 ? 0 : static_cast<double>(evict_ns) / static_cast<double>(evictions),
+          static_cast<double>(replacer_bytes) / static_cast<double>(pool_size)};
+}
+
+/** Parse a comma-separated list of sizes. */
+auto ParseSizes(const std::string &list) -> std::vector<size_t> {
+  std::vector<size_t> sizes;
+  for (const auto &item : bustub::StringUtil::Split(list, ',')) {
+    if (!item.empty()) {
+      sizes.push_back(std::stoul(item));
+    }
+  }
+  return sizes;
+}
+
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--trace").help("replay a trace written by `\\bptrace stop <file>` instead of a synthetic one");
+  program.add_argument("--workload").help("synthetic trace: zipf or scan-mix").default_value(std::string("zipf"));
+  program.add_argument("--pages").help("number of distinct pages of the synthetic trace");
+  program.add_argument("--accesses").help("number of accesses of the synthetic trace");
+  program.add_argument("--theta").help("skew of the Zipfian accesses, between 0 and 1");
+  program.add_argument("--scan-fraction").help("fraction of scan accesses for scan-mix");
+  program.add_argument("--scan-length").help("pages per scan for scan-mix, default pages / 16");
+  program.add_argument("--seed").help("random seed of the synthetic trace").default_value(std::string("42"));
+  program.add_argument("--save-trace").help("write the synthetic trace to a file, in the `\\bptrace` format");
+  program.add_argument("--pool-sizes").help("comma-separated pool sizes, default 1/64, 1/16 and 1/4 of the pages");
+  program.add_argument("--k").help("comma-separated values of k for lru-k").default_value(
+      fmt::format("2,4,{}", bustub::LRUK_REPLACER_K));
+  program.add_argument("--policies").help("comma-separated policies: lru, clock, lru-k, arc, 2q").default_value(
+      std::string("lru,clock,lru-k,arc,2q"));
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  std::vector<bustub::AccessRecord> trace;
+  std::string trace_name;
+  if (program.present("--trace")) {
+    const auto file_name = program.get("--trace");
+    std::ifstream file(file_name);
+    if (!file) {
+      std::cerr << "cannot open trace file: " << file_name << std::endl;
+      return 1;
+    }
+    trace = bustub::AccessTrace::ReadFrom(file);
+    trace_name = file_name;
+  } else {
+    const auto workload = program.get("--workload");
+    if (workload != "zipf" && workload != "scan-mix") {
+      std::cerr << "unknown workload: " << workload << std::endl;
+      std::cerr << program;
+      return 1;
+    }
+    const size_t num_pages = program.present("--pages") ? std::stoul(program.get("--pages")) : REPLACER_BENCH_PAGES;
+    const size_t num_accesses =
+        program.present("--accesses") ? std::stoul(program.get("--accesses")) : REPLACER_BENCH_ACCESSES;
+    const double theta = program.present("--theta") ? std::stod(program.get("--theta")) : REPLACER_BENCH_THETA;
+    double scan_fraction = 0;
+    if (workload == "scan-mix") {
+      scan_fraction =
+          program.present("--scan-fraction") ? std::stod(program.get("--scan-fraction")) : REPLACER_BENCH_SCAN_FRACTION;
+    }
+    const size_t scan_length = program.present("--scan-length") ? std::stoul(program.get("--scan-length"))
+                                                                 : std::max<size_t>(1, num_pages / 16);
+    trace = GenerateTrace(num_pages, num_accesses, theta, scan_fraction, scan_length, std::stoull(program.get("--seed")));
+    trace_name = fmt::format("{} pages={} theta={} scan_fraction={} scan_length={}", workload, num_pages, theta,
+                             scan_fraction, scan_length);
+
+    if (program.present("--save-trace")) {
+      bustub::AccessTrace saved(trace.size());
+      for (const auto &access : trace) {
+        saved.Record(access.type_, access.page_id_);
+      }
+      std::ofstream file(program.get("--save-trace"));
+      saved.WriteTo(file);
+    }
+  }
+
+  std::unordered_set<bustub::page_id_t> distinct_pages;
+  size_t num_page_ids = 0;
+  for (const auto &access : trace) {
+    if (access.page_id_ < 0) {
+      std::cerr << "invalid page id in trace: " << access.page_id_ << std::endl;
+      return 1;
+    }
+    distinct_pages.insert(access.page_id_);
+    num_page_ids = std::max(num_page_ids, static_cast<size_t>(access.page_id_) + 1);
+  }
+  std::vector<size_t> pool_sizes;
+  if (program.present("--pool-sizes")) {
+    pool_sizes = ParseSizes(program.get("--pool-sizes"));
+  } else {
+    for (size_t divisor : {64, 16, 4}) {
+      pool_sizes.push_back(std::max<size_t>(1, distinct_pages.size() / divisor));
+    }
+  }
+
+  std::vector<bustub::ReplacerPolicy> policies;
+  for (const auto &name : bustub::StringUtil::Split(program.get("--policies"), ',')) {
+    bustub::ReplacerPolicy policy;
+    if (!bustub::ParseReplacerPolicy(name, &policy)) {
+      std::cerr << "unknown policy: " << name << std::endl;
+      return 1;
+    }
+    policies.push_back(policy);
+  }
+  const auto ks = ParseSizes(program.get("--k"));
+  if (ks.empty() || std::count(ks.begin(), ks.end(), 0) > 0) {
+    std::cerr << "--k needs at least one value, and every value must be at least 1" << std::endl;
+    return 1;
+  }
+
+  fmt::print("<<< BEGIN replacer replay ({}, {} accesses, {} distinct pages)\n", trace_name, trace.size(),
+             distinct_pages.size());
+  fmt::print("{:>10} {:>12} {:>10} {:>12} {:>12} {:>12}\n", "pool_size", "policy", "hit_ratio", "ns/access",
+             "ns/evict", "bytes/frame");
+  for (auto pool_size : pool_sizes) {
+    for (auto policy : policies) {
+      // k only matters to LRU-K.
+      const auto policy_ks = policy == bustub::ReplacerPolicy::LRU_K ? ks : std::vector<size_t>{ks.front()};
+      for (auto k : policy_ks) {
+        auto name = bustub::ReplacerPolicyToString(policy);
+        if (policy == bustub::ReplacerPolicy::LRU_K) {
+          name = fmt::format("lru-{}", k);
+        }
+        const auto result = Replay(policy, k, pool_size, trace, num_page_ids);
+        fmt::print("{:>10} {:>12} {:>10.4f} {:>12.1f} {:>12.1f} {:>12.1f}\n", pool_size, name, result.hit_ratio_,
+                   result.ns_per_access_, result.ns_per_evict_, result.bytes_per_frame_);
+      }
+    }
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}